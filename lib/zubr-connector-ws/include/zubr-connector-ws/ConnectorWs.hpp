@@ -34,48 +34,157 @@ SOFTWARE.
 #include <atomic>
 #include <functional>
 #include <mutex>
+#include <random>
 #include <string>
 #include <thread>
-#include <unordered_map>
+#include <tuple>
+#include <type_traits>
+#include <vector>
 
 #include "websocketpp/client.hpp"
 #include "websocketpp/config/asio_client.hpp"
 
 #include "zubr-core/ConnectorBase.hpp"
+#include "zubr-core/Logger.hpp"
+#include "zubr-core/Mutex.hpp"
 
+#include "Digest.hpp"
 #include "Request.hpp"
 #include "Response.hpp"
 
 
 namespace zubr {
 
+	/// @brief client (network) thread scheduling
+	struct ClientThreadOptions {
+		/// @brief CPU to pin the client thread to, -1 - unpinned
+		int cpu = -1;
+
+		/// @brief SCHED_FIFO priority, 0 - default scheduling
+		int fifoPriority = 0;
+
+		/// @brief spin on poll() instead of blocking in run()
+		bool busyPoll = false;
+
+		/// @brief SO_BUSY_POLL of the socket, microseconds, 0 - off
+		int socketBusyPollUs = 0;
+	};
+
+	/// @brief options applied to the socket of every connection,
+	/// -1 - keep the system default
+	struct SocketOptions {
+		/// @brief disable Nagle's algorithm
+		int noDelay = -1;
+
+		/// @brief acknowledge immediately, re-armed after every message as
+		/// the kernel falls back to delayed acks
+		int quickAck = -1;
+
+		/// @brief SO_RCVBUF / SO_SNDBUF, bytes
+		int rcvBuf = -1;
+		int sndBuf = -1;
+
+		/// @brief IP_TOS (DSCP << 2)
+		int tos = -1;
+
+		int keepAlive = -1;
+		int keepAliveIdleS = -1;
+		int keepAliveIntervalS = -1;
+		int keepAliveCount = -1;
+	};
+
 	/// @brief ZUBR websocket connector
 	class ConnectorWs : public ConnectorBase {
 	protected:
-		std::string m_keyId;
-		std::string m_keySecret;
+		Digest m_digest;
 		std::string m_endpoint;
 		std::string m_hostname;
 
 		const SerializerFactory & m_serializerFactory;
 
+		/// @brief bytes preallocated for an incoming message document
+		static constexpr size_t DecoderArenaSize = 1024 * 1024;
+
+		/// @brief reused for every incoming message, along with the responses
+		std::shared_ptr<Serializer> m_decoder;
+		ResponsePool m_responsePool;
+
 		websocketpp::client<websocketpp::config::asio_tls_client> m_client;
 		websocketpp::client<
 			websocketpp::config::asio_tls_client>::connection_ptr m_connection;
 
+		/// @brief interval between pings sent to keep the connection alive
+		static constexpr long PingIntervalMs = 14000;
+
+		/// @brief loop wake latency is sampled by a timer of this interval
+		/// and reported every LatencyReportSamples samples
+		static constexpr long LatencyProbeIntervalMs = 100;
+		static constexpr int LatencyReportSamples = 100;
+
+		ClientThreadOptions m_clientThreadOptions;
+		SocketOptions m_socketOptions;
+
+		/// @brief socket of the current connection, -1 - none
+		int m_socketFd;
+
+		/// @brief reconnect backoff, doubled per failed attempt
+		static constexpr long ReconnectDelayMinMs = 10;
+		static constexpr long ReconnectDelayMaxMs = 5000;
+
 		std::thread m_clientThread;
-		std::thread m_pingThread;
 		std::atomic_flag m_isRunning;
 
-		std::mutex m_sendSync;
+		/// @brief connection attempts since the last successful open
+		int m_reconnectAttempt;
+		std::minstd_rand m_random;
+
+		/// @brief shared by all connections, with the session to resume
+		websocketpp::lib::shared_ptr<websocketpp::lib::asio::ssl::context>
+			m_tlsContext;
+		SSL_SESSION * m_tlsSession;
+
+		websocketpp::client<websocketpp::config::asio_tls_client>::timer_ptr
+			m_pingTimer;
+
+		websocketpp::client<websocketpp::config::asio_tls_client>::timer_ptr
+			m_latencyProbeTimer;
+
+		int m_latencyProbeCount;
+		int64_t m_latencyProbeSumUs;
+		int64_t m_latencyProbeMaxUs;
+
+		/// @brief a no-op with ZUBR_SINGLE_THREADED
+		t_mutex m_sendSync;
 
-		volatile t_req_id m_reqId;
+		/// @brief bytes preallocated for an outgoing request document
+		static constexpr size_t EncoderArenaSize = 16 * 1024;
 
-		std::unordered_map<t_req_id, RequestWs> m_reqMap;
-		std::mutex m_reqMapSync;
+		/// @brief reused for every request, guarded by m_sendSync
+		std::shared_ptr<Serializer> m_encoder;
+		std::string m_sendBuffer;
+
+		t_req_id m_reqId;
+
+		PendingRequests m_pendingRequests;
+
+		InstrumentFilter m_instrumentFilter;
+
+		/// @brief handler of every response type
+		std::tuple<std::function<void( ResponseWs & )>,
+			std::function<void( AuthResponseWs & )>,
+			std::function<void( PlaceOrderResponseWs & )>,
+			std::function<void( ChannelOrdersResponseWs & )>,
+			std::function<void( ChannelOrderFillsResponseWs & )>,
+			std::function<void( ChannelLastTradesResponseWs & )>,
+			std::function<void( ChannelOrderBookResponseWs & )>,
+			std::function<void( ChannelPositionsResponseWs & )>,
+			std::function<void( ChannelInstrumentsResponseWs & )>>
+			m_responseHandlers;
 
 		std::function<void( ResponseWs & )> m_messageHandler;
 		std::function<void( AuthResponseWs & )> m_connectHandler;
+		std::function<void()> m_disconnectHandler;
+		std::function<void( int64_t )> m_latencyProbeHandler;
 
 	protected:
 		void OnWsOpen( websocketpp::connection_hdl hdl );
@@ -84,10 +193,95 @@ namespace zubr {
 				websocketpp::config::asio_tls_client>::message_ptr msg );
 
 		void OnWsFail( websocketpp::connection_hdl );
+		void OnWsClose( websocketpp::connection_hdl );
+		void OnWsTcpPostInit( websocketpp::connection_hdl hdl );
 
 		websocketpp::lib::shared_ptr<websocketpp::lib::asio::ssl::context>
 		OnWsTlsInit( const char * hostname, websocketpp::connection_hdl );
 
+		void OnWsSocketInit( websocketpp::connection_hdl,
+			boost::asio::ssl::stream<boost::asio::ip::tcp::socket> & socket );
+
+		/// @brief cancel timers bound to the connection
+		void stopConnectionTimers();
+
+		/// @brief jittered exponential delay before the next attempt
+		long reconnectDelay();
+
+		/// @brief route incoming messages to OnWsMessage, overridden by
+		/// connectors with their own receive path
+		virtual void bindMessageHandler();
+
+		/// @brief ping on the client event loop every PingIntervalMs
+		void schedulePing();
+
+		/// @brief measure how late the loop handles a due timer
+		void scheduleLatencyProbe();
+
+		/// @brief apply pinning and scheduling to the calling thread
+		void applyClientThreadOptions();
+
+		/// @brief run the client loop until it is out of work
+		void runClientLoop();
+
+		void rearmQuickAck();
+
+		/// @brief hold (1) or flush (0) partial segments
+		void cork( int value );
+
+		/// @brief send request, m_sendSync is to be locked
+		t_req_id sendLocked( RequestWs & r );
+
+		void onAuth( websocketpp::connection_hdl hdl, AuthResponseWs & res );
+		void onAuthFailure( websocketpp::connection_hdl hdl );
+
+		/// @brief decode message and pass the concrete response to visitor,
+		/// the response is recycled once visitor returns
+		/// @tparam TVisitor void( TResponse & ) for every response type
+		template <typename TVisitor>
+		void receive( websocketpp::client<
+						  websocketpp::config::asio_tls_client>::message_ptr msg,
+			TVisitor && visitor )
+		{
+
+			rearmQuickAck();
+
+			auto & payload = msg->get_payload();
+
+			ZUBR_LOG_DEBUG( payload );
+
+			std::visit(
+				[&visitor]( auto * res ) {
+					visitor( *res );
+					res->Reset();
+				},
+				ResponseWs::Deserialize( *m_decoder,
+					payload,
+					m_pendingRequests,
+					m_responsePool,
+					&m_instrumentFilter ) );
+		}
+
+		/// @brief pass decoded response to its handlers
+		template <typename TResponse>
+		void onResponse( websocketpp::connection_hdl hdl, TResponse & res )
+		{
+			if constexpr ( std::is_same_v<TResponse, AuthResponseWs> ) {
+				onAuth( hdl, res );
+			}
+
+			auto & handler = std::get<std::function<void( TResponse & )>>(
+				m_responseHandlers );
+
+			if ( handler ) {
+				handler( res );
+			}
+
+			if ( m_messageHandler ) {
+				m_messageHandler( res );
+			}
+		}
+
 	public:
 		/// @brief ZUBR websocket connector
 		/// @param keyId API key ID
@@ -100,23 +294,43 @@ namespace zubr {
 			const SerializerFactory & serializerFactory,
 			const std::string & endpoint = "wss://uat.zubr.io/api/v1/ws",
 			const std::string & hostname = "uat.zubr.io" )
-			: m_keyId( keyId )
-			, m_keySecret( keySecret )
-			, m_serializerFactory( serializerFactory )
+			: m_digest( keyId, keySecret )
 			, m_endpoint( endpoint )
 			, m_hostname( hostname )
+			, m_serializerFactory( serializerFactory )
+			, m_decoder( serializerFactory.Create( DecoderArenaSize ) )
+			, m_socketFd( -1 )
+			, m_reconnectAttempt( 0 )
+			, m_random( std::random_device()() )
+			, m_tlsSession( nullptr )
+			, m_latencyProbeCount( 0 )
+			, m_latencyProbeSumUs( 0 )
+			, m_latencyProbeMaxUs( 0 )
+			, m_encoder( serializerFactory.Create( EncoderArenaSize ) )
 			, m_reqId( 0 )
 		{
 		}
 
 		virtual ~ConnectorWs()
 		{
-			m_isRunning.clear();
+			Stop();
+			Wait();
+
+			if ( m_tlsSession ) {
+				SSL_SESSION_free( m_tlsSession );
+			}
 		}
 
 		/// @brief send request
 		t_req_id Send( RequestWs & r );
 
+		/// @brief send requests back to back, corked to leave in as few
+		/// segments as possible
+		/// @param requests
+		/// @param ids request ID of each request
+		void SendBurst( const std::vector<RequestWs *> & requests,
+			std::vector<t_req_id> & ids );
+
 		/// @brief send request
 		/// @tparam TReq type of request
 		/// @tparam ...TArgs
@@ -138,7 +352,27 @@ namespace zubr {
 			m_connectHandler = handler;
 		}
 
-		/// @brief set message handler (invoked on every incoming message)
+		/// @brief set disconnection handler (invoked when an open connection
+		/// is closed, before reconnecting)
+		/// @param handler
+		void SetDisconnectHandler( const std::function<void()> & handler )
+		{
+			m_disconnectHandler = handler;
+		}
+
+		/// @brief set loop wake latency handler (invoked on the client
+		/// thread with every sample, microseconds, while connected)
+		/// @param handler
+		void SetLatencyProbeHandler(
+			const std::function<void( int64_t )> & handler )
+		{
+
+			m_latencyProbeHandler = handler;
+		}
+
+		/// @brief set message handler (invoked on every incoming message, after
+		/// the handler of its type), the response and everything it refers to
+		/// are recycled once the handler returns
 		/// @param handler
 		void SetMessageHandler(
 			const std::function<void( ResponseWs & )> & handler )
@@ -147,13 +381,139 @@ namespace zubr {
 			m_messageHandler = handler;
 		}
 
+		/// @brief set handler of responses of one type
+		/// @tparam TResponse concrete response type
+		/// @param handler
+		template <typename TResponse>
+		void SetResponseHandler(
+			const std::function<void( TResponse & )> & handler )
+		{
+
+			std::get<std::function<void( TResponse & )>>( m_responseHandlers )
+				= handler;
+		}
+
+		/// @brief set client thread scheduling, before Start
+		/// @param options
+		void SetClientThreadOptions( const ClientThreadOptions & options )
+		{
+			m_clientThreadOptions = options;
+		}
+
+		/// @brief set socket options of following connections, before Start
+		/// @param options
+		void SetSocketOptions( const SocketOptions & options )
+		{
+			m_socketOptions = options;
+		}
+
+		/// @brief decode channel entries of these instruments only
+		/// @param instrumentIds empty - all instruments
+		void SetInstrumentFilter(
+			const std::unordered_set<t_instrument_id> & instrumentIds )
+		{
+
+			m_instrumentFilter.Set( instrumentIds );
+		}
+
+		/// @brief decoded / skipped channel entry counters
+		const InstrumentFilter & Filter() const
+		{
+			return m_instrumentFilter;
+		}
+
+		/// @brief invoke handler on the client thread after a delay
+		/// @param milliseconds
+		/// @param handler
+		void SetTimer(
+			long milliseconds, const std::function<void()> & handler );
+
+		/// @brief invoke handler on the client thread (thread safe)
+		/// @param handler
+		void Post( const std::function<void()> & handler );
+
 		/// @brief start client
 		void Start() override;
 
+		/// @brief close the connection and stop reconnecting, the client
+		/// thread exits once the close completes (thread safe)
+		void Stop();
+
 		/// @brief wait for client termination
 		void Wait();
 	};
 
+	/// @brief THandler handles responses of TResponse
+	template <typename THandler, typename TResponse, typename = void>
+	struct HandlesResponse : std::false_type {
+	};
+
+	template <typename THandler, typename TResponse>
+	struct HandlesResponse<THandler,
+		TResponse,
+		std::void_t<decltype( std::declval<THandler &>().OnResponse(
+			std::declval<TResponse &>() ) )>> : std::true_type {
+	};
+
+	/// @brief connector with a handler known at compile time, the whole
+	/// receive path from the socket to the handler can be inlined
+	/// @tparam THandler provides OnResponse( TResponse & ) for the response
+	/// types it handles, others are skipped
+	template <typename THandler> class StaticConnectorWs : public ConnectorWs {
+	protected:
+		THandler & m_handler;
+
+	protected:
+		void bindMessageHandler() override
+		{
+			m_client.set_message_handler(
+				[this]( websocketpp::connection_hdl hdl,
+					websocketpp::client<
+						websocketpp::config::asio_tls_client>::message_ptr
+						msg ) { onWsMessage( hdl, msg ); } );
+		}
+
+		void onWsMessage( websocketpp::connection_hdl hdl,
+			websocketpp::client<
+				websocketpp::config::asio_tls_client>::message_ptr msg )
+		{
+
+			receive( msg, [this, &hdl]( auto & res ) {
+				typedef std::decay_t<decltype( res )> t_response;
+
+				if constexpr ( HandlesResponse<THandler, t_response>::value ) {
+					m_handler.OnResponse( res );
+				}
+
+				if constexpr ( std::is_same_v<t_response, AuthResponseWs> ) {
+					if ( !res.IsOk() ) {
+						onAuthFailure( hdl );
+					}
+				}
+			} );
+		}
+
+	public:
+		/// @brief ZUBR websocket connector calling handler directly
+		/// @param handler
+		/// @param keyId API key ID
+		/// @param keySecret API key secret
+		/// @param endpoint API endpoint address
+		/// @param hostname API endpoint hostname
+		/// @return
+		StaticConnectorWs( THandler & handler,
+			const std::string & keyId,
+			const std::string & keySecret,
+			const SerializerFactory & serializerFactory,
+			const std::string & endpoint = "wss://uat.zubr.io/api/v1/ws",
+			const std::string & hostname = "uat.zubr.io" )
+			: ConnectorWs(
+				keyId, keySecret, serializerFactory, endpoint, hostname )
+			, m_handler( handler )
+		{
+		}
+	};
+
 } // namespace zubr
 
 
@@ -31,15 +31,44 @@ SOFTWARE.
 #define __ZUBR_CONNECTOR_WS_DIGEST__H
 
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
 
 namespace zubr {
 
+	/// @brief API request signature, the key is decoded once and reused for
+	/// every authentication
 	class Digest {
+	protected:
+		std::string m_keyId;
+		std::vector<uint8_t> m_key;
+
+		/// @brief "key=<keyId>;time=", signed message without timestamp
+		std::string m_messagePrefix;
+
 	public:
-		static void FromHex(
+		/// @brief signature key
+		/// @param keyId
+		/// @param keySecretHex
+		/// @throw Exception if keySecretHex is not hex
+		Digest( const std::string & keyId, const std::string & keySecretHex );
+
+		const std::string & KeyId() const
+		{
+			return m_keyId;
+		}
+
+		/// @brief calculate signature of the timestamp
+		/// @param out hex digest
+		/// @param ts
+		void Calculate( std::string & out, uint64_t ts ) const;
+
+		/// @brief append bytes of hex, out is left as is if a character is
+		/// not a hex digit
+		/// @return false if a character is not a hex digit
+		static bool FromHex(
 			std::vector<uint8_t> & out, const std::string & hex );
 
 		static void ToHex(
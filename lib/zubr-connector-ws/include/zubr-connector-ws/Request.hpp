@@ -36,6 +36,8 @@ SOFTWARE.
 
 #include "zubr-core/Serializer.hpp"
 
+#include "Digest.hpp"
+#include "Response.hpp"
 #include "Types.hpp"
 
 
@@ -51,17 +53,21 @@ namespace zubr {
 	protected:
 		int m_id;
 		int m_methodId;
-		std::string m_methodName;
+		/// @brief static tag, never copied
+		const char * m_methodName;
 		Channel m_channel;
+		ResponseType m_responseType;
 
 	public:
-		RequestWs( const std::string & methodName = "",
+		RequestWs( const char * methodName = "",
 			int methodId = MethodIdRequest,
-			Channel channel = Channel::_undef )
-			: m_methodName( methodName )
+			Channel channel = Channel::_undef,
+			ResponseType responseType = ResponseType::_undef )
+			: m_id( 0 )
 			, m_methodId( methodId )
+			, m_methodName( methodName )
 			, m_channel( channel )
-			, m_id( 0 )
+			, m_responseType( responseType )
 		{
 		}
 
@@ -90,20 +96,26 @@ namespace zubr {
 
 		/// @brief get method name
 		/// @return
-		const std::string & MethodName() const
+		const char * MethodName() const
 		{
 			return m_methodName;
 		}
+
+		/// @brief type of the response to this request
+		/// @return _undef - response is not decoded
+		ResponseType ExpectedResponseType() const
+		{
+			return m_responseType;
+		}
 	};
 
 	/// @brief authentication request
 	class AuthRequestWs : public RequestWs {
 	protected:
-		std::string m_keyId;
-		std::string m_keySecret;
+		Digest m_digest;
 
 	public:
-		const static std::string ReqMethodName;
+		static constexpr const char * ReqMethodName = "loginSessionByApiToken";
 
 	public:
 		/// @brief authentication request
@@ -112,9 +124,23 @@ namespace zubr {
 		/// @return
 		AuthRequestWs(
 			const std::string & keyId, const std::string & keySecret )
-			: RequestWs( ReqMethodName )
-			, m_keyId( keyId )
-			, m_keySecret( keySecret )
+			: RequestWs( ReqMethodName,
+				  MethodIdRequest,
+				  Channel::_undef,
+				  ResponseType::Auth )
+			, m_digest( keyId, keySecret )
+		{
+		}
+
+		/// @brief authentication request signed with a prepared key
+		/// @param digest
+		/// @return
+		AuthRequestWs( const Digest & digest )
+			: RequestWs( ReqMethodName,
+				  MethodIdRequest,
+				  Channel::_undef,
+				  ResponseType::Auth )
+			, m_digest( digest )
 		{
 		}
 
@@ -133,7 +159,7 @@ namespace zubr {
 		bool m_isReplaceOrder;
 
 	public:
-		const static std::string ReqMethodName;
+		static constexpr const char * ReqMethodName = "placeOrder";
 
 	public:
 		/// @brief place order request
@@ -157,7 +183,10 @@ namespace zubr {
 			int quantity,
 			OrderType type,
 			OrderLifetime lifetime )
-			: RequestWs( ReqMethodName )
+			: RequestWs( ReqMethodName,
+				  MethodIdRequest,
+				  Channel::_undef,
+				  ResponseType::PlaceOrder )
 			, m_instrumentId( instrumentId )
 			, m_price( price )
 			, m_direction( direction )
@@ -170,6 +199,11 @@ namespace zubr {
 
 		void Serialize( Serializer & s ) override;
 
+		int InstrumentId() const
+		{
+			return m_instrumentId;
+		}
+
 		OrderDirection Direction() const
 		{
 			return m_direction;
@@ -213,7 +247,7 @@ namespace zubr {
 		int m_quantity;
 
 	public:
-		const static std::string ReqMethodName;
+		static constexpr const char * ReqMethodName = "replaceOrder";
 
 	public:
 		/// @brief replace order request
@@ -234,7 +268,7 @@ namespace zubr {
 		t_order_id m_orderId;
 
 	public:
-		const static std::string ReqMethodName;
+		static constexpr const char * ReqMethodName = "cancelOrder";
 
 	public:
 		/// @brief cancel order request
@@ -256,6 +290,15 @@ namespace zubr {
 		}
 	};
 
+	/// @brief channel unsubscription request
+	class UnsubscribeRequestWs : public RequestWs {
+	public:
+		UnsubscribeRequestWs( Channel channel )
+			: RequestWs( "", MethodIdUnsubscribe, channel )
+		{
+		}
+	};
+
 } // namespace zubr
 
 
@@ -31,11 +31,17 @@ SOFTWARE.
 #define __ZUBR_CONNECTOR_WS_RESPONSE__H
 
 
-#include <functional>
+#include <array>
+#include <atomic>
 #include <memory>
 #include <string>
+#include <tuple>
+#include <unordered_set>
+#include <variant>
 #include <vector>
 
+#include "zubr-core/RecyclingMap.hpp"
+
 #include "Types.hpp"
 
 
@@ -46,11 +52,134 @@ namespace zubr {
 		Auth,
 		PlaceOrder,
 		ChannelOrders,
+		ChannelOrderFills,
+		ChannelLastTrades,
 		ChannelOrderBook,
 		ChannelPositions,
 		ChannelInstruments
 	};
 
+	/// @brief instruments of interest, channel entries of other instruments
+	/// are skipped without being decoded
+	class InstrumentFilter {
+	protected:
+		std::unordered_set<t_instrument_id> m_instrumentIds;
+
+		std::atomic<uint64_t> m_decodedCount;
+		std::atomic<uint64_t> m_skippedCount;
+
+	public:
+		InstrumentFilter()
+			: m_decodedCount( 0 )
+			, m_skippedCount( 0 )
+		{
+		}
+
+		/// @brief set instruments of interest, empty - all
+		/// @param instrumentIds
+		void Set( const std::unordered_set<t_instrument_id> & instrumentIds )
+		{
+			m_instrumentIds = instrumentIds;
+		}
+
+		/// @brief check entry of the instrument should be decoded
+		bool operator()( t_instrument_id instrumentId )
+		{
+			if ( m_instrumentIds.empty()
+				 || m_instrumentIds.count( instrumentId ) > 0 ) {
+
+				m_decodedCount.fetch_add( 1, std::memory_order_relaxed );
+				return true;
+			}
+
+			m_skippedCount.fetch_add( 1, std::memory_order_relaxed );
+
+			return false;
+		}
+
+		/// @brief number of decoded entries
+		uint64_t DecodedCount() const
+		{
+			return m_decodedCount.load( std::memory_order_relaxed );
+		}
+
+		/// @brief number of entries skipped without decoding
+		uint64_t SkippedCount() const
+		{
+			return m_skippedCount.load( std::memory_order_relaxed );
+		}
+	};
+
+	/// @brief response types of requests in flight, a lock-free ring indexed
+	/// by request ID: written by senders, read by the network thread
+	class PendingRequests {
+	protected:
+		static constexpr size_t Capacity = 4096;
+
+		/// @brief request ID << 8 | response type
+		std::array<std::atomic<uint64_t>, Capacity> m_slots;
+
+	public:
+		PendingRequests()
+		{
+			for ( auto & slot : m_slots ) {
+				slot.store( 0, std::memory_order_relaxed );
+			}
+		}
+
+		/// @brief remember type of the response expected for the request
+		/// @param id
+		/// @param type
+		void Add( t_req_id id, ResponseType type )
+		{
+			m_slots[id & ( Capacity - 1 )].store(
+				( static_cast<uint64_t>( id ) << 8 )
+					| static_cast<uint64_t>( type ),
+				std::memory_order_release );
+		}
+
+		/// @brief response type of the request, _undef if unknown or
+		/// overwritten by a later request
+		/// @param id
+		/// @return
+		ResponseType Find( t_req_id id ) const
+		{
+			auto slot = m_slots[id & ( Capacity - 1 )].load(
+				std::memory_order_acquire );
+
+			if ( ( slot >> 8 ) != static_cast<uint64_t>( id ) ) {
+				return ResponseType::_undef;
+			}
+
+			return static_cast<ResponseType>( slot & 0xff );
+		}
+	};
+
+	class ResponseWs;
+	class AuthResponseWs;
+	class PlaceOrderResponseWs;
+	class ChannelOrdersResponseWs;
+	class ChannelOrderFillsResponseWs;
+	class ChannelLastTradesResponseWs;
+	class ChannelOrderBookResponseWs;
+	class ChannelPositionsResponseWs;
+	class ChannelInstrumentsResponseWs;
+
+	/// @brief decoded message by its concrete response type, ResponseWs for
+	/// unrecognized messages
+	typedef std::variant<ResponseWs *,
+		AuthResponseWs *,
+		PlaceOrderResponseWs *,
+		ChannelOrdersResponseWs *,
+		ChannelOrderFillsResponseWs *,
+		ChannelLastTradesResponseWs *,
+		ChannelOrderBookResponseWs *,
+		ChannelPositionsResponseWs *,
+		ChannelInstrumentsResponseWs *>
+		ResponseRef;
+
+	class ResponsePool;
+
 	class ResponseWs : public Serializable {
 	protected:
 		t_req_id m_id;
@@ -58,24 +187,46 @@ namespace zubr {
 		ResponseType m_type;
 		std::string m_errorCodeName;
 
+		InstrumentFilter * m_filter;
+
 	public:
 		ResponseWs( ResponseType type = ResponseType::_undef )
 			: m_type( type )
 			, m_isOk( false )
 			, m_id( -1 )
+			, m_filter( nullptr )
 		{
 		}
 
-		static std::shared_ptr<ResponseWs> Deserialize( Serializer & s,
+		virtual ~ResponseWs()
+		{
+		}
+
+		/// @brief deserialize incoming message into a pooled response
+		/// @param s
+		/// @param in
+		/// @param pending response types of requests in flight
+		/// @param pool
+		/// @param filter instruments of interest, nullptr - all
+		/// @return valid until reset, refers to the message held by s
+		static ResponseRef Deserialize( Serializer & s,
 			const std::string & in,
-			const std::function<ResponseType( t_req_id id )> & typeResolver );
+			const PendingRequests & pending,
+			ResponsePool & pool,
+			InstrumentFilter * filter = nullptr );
 
 		void Deserialize( Serializer & s ) override
 		{
 		}
 
-		void Deserialize(
-			const std::shared_ptr<ResponseWs> & out, Serializer & s );
+		/// @brief forget decoded content, containers keep their memory
+		virtual void Reset()
+		{
+			m_id = -1;
+			m_isOk = false;
+			m_errorCodeName.clear();
+			m_filter = nullptr;
+		}
 
 		ResponseType Type() const
 		{
@@ -98,6 +249,20 @@ namespace zubr {
 		{
 			return m_errorCodeName;
 		}
+
+	protected:
+		/// @brief decode result status
+		/// @param s
+		/// @return value of a successful result, nullptr otherwise
+		std::shared_ptr<Serializer> deserializeStatus( Serializer & s );
+
+		/// @brief decode result into the concrete response, without virtual
+		/// dispatch
+		template <typename TResponse>
+		static ResponseRef deserialize( TResponse & res,
+			t_req_id id,
+			InstrumentFilter * filter,
+			Serializer & s );
 	};
 
 	/// @brief authentication response
@@ -139,17 +304,106 @@ namespace zubr {
 
 	class ChannelOrdersResponseWs : public ResponseWs {
 	protected:
-		std::unordered_map<t_order_id, OrderEntry> m_entries;
+		RecyclingMap<t_order_id, OrderEntry> m_entries;
+		bool m_isSnapshot;
 
 	public:
 		ChannelOrdersResponseWs()
 			: ResponseWs( ResponseType::ChannelOrders )
+			, m_isSnapshot( false )
 		{
 		}
 
 		void Deserialize( Serializer & s ) override;
 
-		const std::unordered_map<t_order_id, OrderEntry> & Entries() const
+		void Reset() override
+		{
+			ResponseWs::Reset();
+			m_entries.clear();
+			m_isSnapshot = false;
+		}
+
+		/// @brief entries are the complete state (sent once after
+		/// subscription), not a change
+		bool IsSnapshot() const
+		{
+			return m_isSnapshot;
+		}
+
+		const RecyclingMap<t_order_id, OrderEntry> & Entries() const
+		{
+			return m_entries;
+		}
+	};
+
+	class ChannelOrderFillsResponseWs : public ResponseWs {
+	protected:
+		RecyclingMap<t_order_id, OrderFill> m_entries;
+		bool m_isSnapshot;
+
+	public:
+		ChannelOrderFillsResponseWs()
+			: ResponseWs( ResponseType::ChannelOrderFills )
+			, m_isSnapshot( false )
+		{
+		}
+
+		void Deserialize( Serializer & s ) override;
+
+		void Reset() override
+		{
+			ResponseWs::Reset();
+			m_entries.clear();
+			m_isSnapshot = false;
+		}
+
+		/// @brief recent fills sent once after subscription, already
+		/// reflected in the positions; entries are not decoded
+		bool IsSnapshot() const
+		{
+			return m_isSnapshot;
+		}
+
+		/// @brief fills in the order received
+		const RecyclingMap<t_order_id, OrderFill> & Entries() const
+		{
+			return m_entries;
+		}
+	};
+
+	class ChannelLastTradesResponseWs : public ResponseWs {
+	protected:
+		RecyclingMap<t_order_id, Trade> m_entries;
+		bool m_isSnapshot;
+
+	protected:
+		/// @brief decode trade unless its instrument is filtered out
+		void add( Serializer & s );
+
+	public:
+		ChannelLastTradesResponseWs()
+			: ResponseWs( ResponseType::ChannelLastTrades )
+			, m_isSnapshot( false )
+		{
+		}
+
+		void Deserialize( Serializer & s ) override;
+
+		void Reset() override
+		{
+			ResponseWs::Reset();
+			m_entries.clear();
+			m_isSnapshot = false;
+		}
+
+		/// @brief recent trades sent once after subscription
+		bool IsSnapshot() const
+		{
+			return m_isSnapshot;
+		}
+
+		/// @brief trades in the order received
+		const RecyclingMap<t_order_id, Trade> & Entries() const
 		{
 			return m_entries;
 		}
@@ -157,7 +411,7 @@ namespace zubr {
 
 	class ChannelOrderBookResponseWs : public ResponseWs {
 	protected:
-		std::unordered_map<t_instrument_id, OrderBookEntry> m_entries;
+		RecyclingMap<t_instrument_id, OrderBookEntry> m_entries;
 
 	public:
 		ChannelOrderBookResponseWs()
@@ -167,7 +421,13 @@ namespace zubr {
 
 		void Deserialize( Serializer & s ) override;
 
-		const std::unordered_map<t_instrument_id, OrderBookEntry> &
+		void Reset() override
+		{
+			ResponseWs::Reset();
+			m_entries.clear();
+		}
+
+		const RecyclingMap<t_instrument_id, OrderBookEntry> &
 		Entries() const
 		{
 			return m_entries;
@@ -176,17 +436,33 @@ namespace zubr {
 
 	class ChannelPositionsResponseWs : public ResponseWs {
 	protected:
-		std::unordered_map<t_instrument_id, Position> m_entries;
+		RecyclingMap<t_instrument_id, Position> m_entries;
+		bool m_isSnapshot;
 
 	public:
 		ChannelPositionsResponseWs()
 			: ResponseWs( ResponseType::ChannelPositions )
+			, m_isSnapshot( false )
 		{
 		}
 
 		void Deserialize( Serializer & s ) override;
 
-		const std::unordered_map<t_instrument_id, Position> & Entries() const
+		void Reset() override
+		{
+			ResponseWs::Reset();
+			m_entries.clear();
+			m_isSnapshot = false;
+		}
+
+		/// @brief entries are the complete state (sent once after
+		/// subscription), not a change
+		bool IsSnapshot() const
+		{
+			return m_isSnapshot;
+		}
+
+		const RecyclingMap<t_instrument_id, Position> & Entries() const
 		{
 			return m_entries;
 		}
@@ -194,7 +470,7 @@ namespace zubr {
 
 	class ChannelInstrumentsResponseWs : public ResponseWs {
 	protected:
-		std::unordered_map<t_instrument_id, Instrument> m_list;
+		RecyclingMap<t_instrument_id, Instrument> m_list;
 
 	public:
 		ChannelInstrumentsResponseWs()
@@ -204,12 +480,41 @@ namespace zubr {
 
 		void Deserialize( Serializer & s ) override;
 
-		const std::unordered_map<t_instrument_id, Instrument> & List() const
+		void Reset() override
+		{
+			ResponseWs::Reset();
+			m_list.clear();
+		}
+
+		const RecyclingMap<t_instrument_id, Instrument> & List() const
 		{
 			return m_list;
 		}
 	};
 
+	/// @brief one reusable response of every type, a connection decodes each
+	/// message into the response of its type and resets it after handling,
+	/// so no response is allocated per message
+	class ResponsePool {
+	protected:
+		std::tuple<ResponseWs,
+			AuthResponseWs,
+			PlaceOrderResponseWs,
+			ChannelOrdersResponseWs,
+			ChannelOrderFillsResponseWs,
+			ChannelLastTradesResponseWs,
+			ChannelOrderBookResponseWs,
+			ChannelPositionsResponseWs,
+			ChannelInstrumentsResponseWs>
+			m_responses;
+
+	public:
+		template <typename TResponse> TResponse & Get()
+		{
+			return std::get<TResponse>( m_responses );
+		}
+	};
+
 } // namespace zubr
 
 
@@ -33,7 +33,9 @@ SOFTWARE.
 
 #include <chrono>
 #include <cmath>
+#include <string_view>
 
+#include "zubr-core/EnumCodec.hpp"
 #include "zubr-core/Serializer.hpp"
 #include "zubr-core/Types.hpp"
 
@@ -57,47 +59,56 @@ namespace zubr {
 		Tickers
 	};
 
+	/// @brief channel message kind
+	enum class ChannelMessageType { _undef = 0, Snapshot, Update };
+
+	/// @brief request result tag
+	enum class ResultTag { _undef = 0, Ok, Err };
+
 	class ChannelEnumHelper {
+	protected:
+		static constexpr EnumName<Channel> ChannelNames[]
+			= { { "instruments", Channel::Instruments },
+				{ "orders", Channel::Orders },
+				{ "orderFills", Channel::OrderFills },
+				{ "lastTrades", Channel::LastTrades },
+				{ "positions", Channel::Positions },
+				{ "orderbook", Channel::OrderBook },
+				{ "balance", Channel::Balance },
+				{ "candles", Channel::Candles },
+				{ "riskSettings", Channel::RiskSettings },
+				{ "tickers", Channel::Tickers } };
+
+		static constexpr EnumName<ChannelMessageType> MessageTypeNames[]
+			= { { "snapshot", ChannelMessageType::Snapshot },
+				{ "update", ChannelMessageType::Update } };
+
+		static constexpr EnumName<ResultTag> ResultTagNames[]
+			= { { "ok", ResultTag::Ok }, { "err", ResultTag::Err } };
+
+		static constexpr EnumCodec ChannelCodec{ ChannelNames };
+		static constexpr EnumCodec MessageTypeCodec{ MessageTypeNames };
+		static constexpr EnumCodec ResultTagCodec{ ResultTagNames };
+
 	public:
 		static const char * ToString( Channel channel )
 		{
-			switch ( channel ) {
-				case Channel::Instruments:
-					return "instruments";
-
-				case Channel::OrderBook:
-					return "orderbook";
-
-				case Channel::Orders:
-					return "orders";
-
-				case Channel::Positions:
-					return "positions";
-
-				default:
-					return "N/A";
-			}
+			return ChannelCodec.ToString( channel );
 		}
 
-		static Channel FromChannelName( const std::string & name )
+		static Channel FromChannelName( std::string_view name )
 		{
-			if ( ToString( Channel::Instruments ) == name ) {
-				return Channel::Instruments;
-			}
-
-			if ( ToString( Channel::OrderBook ) == name ) {
-				return Channel::OrderBook;
-			}
-
-			if ( ToString( Channel::Orders ) == name ) {
-				return Channel::Orders;
-			}
+			return ChannelCodec.FromString( name );
+		}
 
-			if ( ToString( Channel::Positions ) == name ) {
-				return Channel::Positions;
-			}
+		static ChannelMessageType FromMessageTypeName( std::string_view name )
+		{
+			return MessageTypeCodec.FromString( name );
+		}
 
-			return Channel::_undef;
+		static ResultTag FromResultTagName( std::string_view name )
+		{
+			return ResultTagCodec.FromString( name );
 		}
 	};
 
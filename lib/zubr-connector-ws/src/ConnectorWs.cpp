@@ -27,7 +27,21 @@ SOFTWARE.
 /// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
 ///
 
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
 #include <limits>
+#include <random>
+#include <sstream>
+
+#include <pthread.h>
+#include <sched.h>
+#include <netinet/in.h>
+#include <netinet/ip.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
 
 #include "zubr-core/Logger.hpp"
 
@@ -40,122 +54,439 @@ SOFTWARE.
 using namespace zubr;
 
 
+/// @brief socket option to apply, value -1 - keep the system default
+struct socketOption {
+	int level;
+	int name;
+	const char * label;
+	int value;
+};
+
+static std::array<socketOption, 10> socketOptionTable(
+	const SocketOptions & o, int busyPollUs )
+{
+
+	return { {
+		{ IPPROTO_TCP, TCP_NODELAY, "TCP_NODELAY", o.noDelay },
+		{ IPPROTO_TCP, TCP_QUICKACK, "TCP_QUICKACK", o.quickAck },
+		{ SOL_SOCKET, SO_RCVBUF, "SO_RCVBUF", o.rcvBuf },
+		{ SOL_SOCKET, SO_SNDBUF, "SO_SNDBUF", o.sndBuf },
+		{ IPPROTO_IP, IP_TOS, "IP_TOS", o.tos },
+		{ SOL_SOCKET, SO_KEEPALIVE, "SO_KEEPALIVE", o.keepAlive },
+		{ IPPROTO_TCP, TCP_KEEPIDLE, "TCP_KEEPIDLE", o.keepAliveIdleS },
+		{ IPPROTO_TCP, TCP_KEEPINTVL, "TCP_KEEPINTVL", o.keepAliveIntervalS },
+		{ IPPROTO_TCP, TCP_KEEPCNT, "TCP_KEEPCNT", o.keepAliveCount },
+		{ SOL_SOCKET,
+			SO_BUSY_POLL,
+			"SO_BUSY_POLL",
+			busyPollUs > 0 ? busyPollUs : -1 },
+	} };
+}
+
+
 void ConnectorWs::OnWsOpen( websocketpp::connection_hdl hdl )
 {
 	m_client.get_alog().write(
 		websocketpp::log::alevel::app, "Connection opened" );
 
-	Send<AuthRequestWs>( m_keyId, m_keySecret );
+	m_reconnectAttempt = 0;
+
+	websocketpp::lib::error_code ec;
+	auto connection = m_client.get_con_from_hdl( hdl, ec );
+
+	if ( connection && !ec ) {
+		auto ssl = connection->get_socket().native_handle();
+
+		ZUBR_LOG_INFO( "connected, TLS session "
+					   << ( SSL_session_reused( ssl ) ? "resumed" : "new" ) );
+
+		// kept for the next connection to resume
+		auto session = SSL_get1_session( ssl );
+
+		if ( session ) {
+			if ( m_tlsSession ) {
+				SSL_SESSION_free( m_tlsSession );
+			}
+
+			m_tlsSession = session;
+		}
+	}
+
+	Send<AuthRequestWs>( m_digest );
+
+	schedulePing();
+	scheduleLatencyProbe();
+}
+
+void ConnectorWs::OnWsClose( websocketpp::connection_hdl )
+{
+	stopConnectionTimers();
+
+	if ( m_disconnectHandler ) {
+		m_disconnectHandler();
+	}
+}
+
+void ConnectorWs::stopConnectionTimers()
+{
+	// a pending ping would keep the client loop running after disconnect
+	if ( m_pingTimer ) {
+		m_pingTimer->cancel();
+		m_pingTimer.reset();
+	}
+
+	if ( m_latencyProbeTimer ) {
+		m_latencyProbeTimer->cancel();
+		m_latencyProbeTimer.reset();
+	}
+
+	m_socketFd = -1;
+}
+
+void ConnectorWs::OnWsTcpPostInit( websocketpp::connection_hdl hdl )
+{
+	websocketpp::lib::error_code ec;
+	auto connection = m_client.get_con_from_hdl( hdl, ec );
+
+	if ( !connection || ec ) {
+		return;
+	}
+
+	m_socketFd = connection->get_raw_socket().native_handle();
+
+	auto options = socketOptionTable(
+		m_socketOptions, m_clientThreadOptions.socketBusyPollUs );
+
+	std::stringstream applied;
+
+	for ( auto & option : options ) {
+		if ( option.value >= 0
+			 && 0
+					!= setsockopt( m_socketFd,
+						option.level,
+						option.name,
+						&option.value,
+						sizeof( option.value ) ) ) {
+
+			ZUBR_LOG_ERROR( option.label << ": " << std::strerror( errno ) );
+		}
+
+		int value = 0;
+		socklen_t size = sizeof( value );
+
+		if ( 0
+			 == getsockopt(
+				 m_socketFd, option.level, option.name, &value, &size ) ) {
+
+			applied << " " << option.label << "=" << value;
+		}
+	}
+
+	ZUBR_LOG_INFO( "socket options:" << applied.str() );
+}
+
+void ConnectorWs::rearmQuickAck()
+{
+	if ( m_socketOptions.quickAck > 0 && m_socketFd >= 0 ) {
+		int value = 1;
+		setsockopt(
+			m_socketFd, IPPROTO_TCP, TCP_QUICKACK, &value, sizeof( value ) );
+	}
+}
+
+void ConnectorWs::schedulePing()
+{
+	if ( m_pingTimer ) {
+		m_pingTimer->cancel();
+	}
+
+	m_pingTimer = m_client.set_timer(
+		PingIntervalMs, [this]( const websocketpp::lib::error_code & ec ) {
+			if ( ec ) {
+				return;
+			}
+
+			{
+				const std::lock_guard<t_mutex> lock( m_sendSync );
+
+				websocketpp::lib::error_code pingEc;
+				m_client.ping(
+					m_connection->get_handle(), "zubrobot-ws", pingEc );
+			}
+
+			schedulePing();
+		} );
 }
 
 void ConnectorWs::OnWsMessage( websocketpp::connection_hdl hdl,
 	websocketpp::client<websocketpp::config::asio_tls_client>::message_ptr msg )
 {
-	auto & payload = msg->get_payload();
+	receive(
+		msg, [this, &hdl]( auto & res ) { onResponse( hdl, res ); } );
+}
 
-	ZUBR_LOG_DEBUG( payload );
+void ConnectorWs::scheduleLatencyProbe()
+{
+	if ( m_latencyProbeTimer ) {
+		m_latencyProbeTimer->cancel();
+	}
 
-	auto res = ResponseWs::Deserialize(
-		*m_serializerFactory.Create(), payload, [this]( t_req_id id ) {
-			const std::lock_guard<std::mutex> lock( m_reqMapSync );
-			auto reqMapIt = m_reqMap.find( id );
+	auto due = std::chrono::steady_clock::now()
+			   + std::chrono::milliseconds( LatencyProbeIntervalMs );
 
-			if ( m_reqMap.end() != reqMapIt ) {
-				if ( reqMapIt->second.MethodName()
-					 == AuthRequestWs::ReqMethodName ) {
+	m_latencyProbeTimer = m_client.set_timer( LatencyProbeIntervalMs,
+		[this, due]( const websocketpp::lib::error_code & ec ) {
+			if ( ec ) {
+				return;
+			}
 
-					return ResponseType::Auth;
-				}
+			auto latency = std::chrono::steady_clock::now() - due;
+			int64_t latencyUs
+				= std::chrono::duration_cast<std::chrono::microseconds>(
+					latency )
+					  .count();
 
-				if ( reqMapIt->second.MethodName()
-					 == PlaceOrderRequestWs::ReqMethodName ) {
+			++m_latencyProbeCount;
+			m_latencyProbeSumUs += latencyUs;
+			m_latencyProbeMaxUs = std::max( m_latencyProbeMaxUs, latencyUs );
 
-					return ResponseType::PlaceOrder;
-				}
+			if ( m_latencyProbeHandler ) {
+				m_latencyProbeHandler( latencyUs );
+			}
 
-				m_reqMap.erase( id );
+			if ( LatencyReportSamples == m_latencyProbeCount ) {
+				ZUBR_LOG_INFO( "loop wake latency, us: mean "
+							   << m_latencyProbeSumUs / m_latencyProbeCount
+							   << ", max " << m_latencyProbeMaxUs
+							   << ( m_clientThreadOptions.busyPoll
+										  ? " (busy poll)"
+										  : " (blocking)" ) );
+
+				m_latencyProbeCount = 0;
+				m_latencyProbeSumUs = 0;
+				m_latencyProbeMaxUs = 0;
 			}
 
-			return ResponseType::_undef;
+			scheduleLatencyProbe();
 		} );
+}
 
-	if ( res->Type() == ResponseType::Auth ) {
-		if ( m_connectHandler ) {
-			m_connectHandler( *static_cast<AuthResponseWs *>( res.get() ) );
+void ConnectorWs::applyClientThreadOptions()
+{
+	if ( m_clientThreadOptions.cpu >= 0 ) {
+		cpu_set_t cpus;
+		CPU_ZERO( &cpus );
+		CPU_SET( m_clientThreadOptions.cpu, &cpus );
 
-			if ( !res->IsOk() ) {
-				ZUBR_LOG_ERROR( "authentication failed" );
-				m_isRunning.clear();
+		if ( 0
+			 != pthread_setaffinity_np(
+				 pthread_self(), sizeof( cpus ), &cpus ) ) {
 
-				websocketpp::lib::error_code ec;
-				m_client.close(
-					hdl, websocketpp::close::status::normal, "foo", ec );
-			}
+			ZUBR_LOG_ERROR( "failed to pin client thread to CPU "
+							<< m_clientThreadOptions.cpu );
 		}
 	}
 
-	if ( m_messageHandler ) {
-		m_messageHandler( *res );
+	if ( m_clientThreadOptions.fifoPriority > 0 ) {
+		sched_param param;
+		param.sched_priority = m_clientThreadOptions.fifoPriority;
+
+		auto rc = pthread_setschedparam( pthread_self(), SCHED_FIFO, &param );
+
+		if ( 0 != rc ) {
+			ZUBR_LOG_ERROR( "SCHED_FIFO: " << std::strerror( rc ) );
+		}
+	}
+}
+
+void ConnectorWs::runClientLoop()
+{
+	if ( !m_clientThreadOptions.busyPoll ) {
+		m_client.run();
+		return;
+	}
+
+	// never sleeps in epoll, the loop stops once it is out of work
+	while ( !m_client.stopped() ) {
+		m_client.poll();
 	}
 }
 
+void ConnectorWs::bindMessageHandler()
+{
+	m_client.set_message_handler(
+		websocketpp::lib::bind( &ConnectorWs::OnWsMessage,
+			this,
+			websocketpp::lib::placeholders::_1,
+			websocketpp::lib::placeholders::_2 ) );
+}
+
+void ConnectorWs::onAuth(
+	websocketpp::connection_hdl hdl, AuthResponseWs & res )
+{
+
+	if ( m_connectHandler ) {
+		m_connectHandler( res );
+
+		if ( !res.IsOk() ) {
+			onAuthFailure( hdl );
+		}
+	}
+}
+
+void ConnectorWs::onAuthFailure( websocketpp::connection_hdl hdl )
+{
+	ZUBR_LOG_ERROR( "authentication failed" );
+	m_isRunning.clear();
+
+	websocketpp::lib::error_code ec;
+	m_client.close( hdl, websocketpp::close::status::normal, "foo", ec );
+}
+
 void ConnectorWs::OnWsFail( websocketpp::connection_hdl )
 {
 	ZUBR_LOG_ERROR( "ConnectorWs::OnWsFail" );
-	m_isRunning.clear();
-	m_client.stop();
+
+	// the client loop runs out of work and the connection is retried
+	stopConnectionTimers();
 }
 
 websocketpp::lib::shared_ptr<websocketpp::lib::asio::ssl::context>
 ConnectorWs::OnWsTlsInit( const char * hostname, websocketpp::connection_hdl )
 {
-	websocketpp::lib::shared_ptr<websocketpp::lib::asio::ssl::context> ctx
-		= websocketpp::lib::make_shared<boost::asio::ssl::context>(
-			boost::asio::ssl::context::sslv23 );
+	// one context for all connections, sessions are resumed across them
+	if ( m_tlsContext ) {
+		return m_tlsContext;
+	}
+
+	m_tlsContext = websocketpp::lib::make_shared<boost::asio::ssl::context>(
+		boost::asio::ssl::context::sslv23 );
 
 	try {
-		ctx->set_options( boost::asio::ssl::context::default_workarounds
-						  | boost::asio::ssl::context::no_sslv2
-						  | boost::asio::ssl::context::no_sslv3
-						  | boost::asio::ssl::context::single_dh_use );
+		m_tlsContext->set_options(
+			boost::asio::ssl::context::default_workarounds
+			| boost::asio::ssl::context::no_sslv2
+			| boost::asio::ssl::context::no_sslv3
+			| boost::asio::ssl::context::single_dh_use );
+
+		m_tlsContext->set_verify_mode( boost::asio::ssl::verify_none );
 
-		ctx->set_verify_mode( boost::asio::ssl::verify_none );
+		SSL_CTX_set_session_cache_mode(
+			m_tlsContext->native_handle(), SSL_SESS_CACHE_CLIENT );
 	}
 	catch ( std::exception & e ) {
 		std::cout << e.what() << std::endl;
 	}
 
-	return ctx;
+	return m_tlsContext;
+}
+
+void ConnectorWs::OnWsSocketInit( websocketpp::connection_hdl,
+	boost::asio::ssl::stream<boost::asio::ip::tcp::socket> & socket )
+{
+
+	auto ssl = socket.native_handle();
+
+	SSL_set_tlsext_host_name( ssl, m_hostname.c_str() );
+
+	if ( m_tlsSession ) {
+		SSL_set_session( ssl, m_tlsSession );
+	}
+}
+
+long ConnectorWs::reconnectDelay()
+{
+	auto shift = std::min( m_reconnectAttempt - 1, 16 );
+	auto delay
+		= std::min( ReconnectDelayMaxMs, ReconnectDelayMinMs << shift );
+
+	// half fixed, half random: spreads reconnects of many clients while
+	// keeping the first retry within milliseconds
+	std::uniform_int_distribution<long> jitter( 0, delay / 2 );
+
+	return delay - delay / 2 + jitter( m_random );
 }
 
 zubr::t_req_id ConnectorWs::Send( RequestWs & r )
 {
-	const std::lock_guard<std::mutex> lock( m_sendSync );
+	const std::lock_guard<t_mutex> lock( m_sendSync );
+
+	return sendLocked( r );
+}
+
+void ConnectorWs::SendBurst(
+	const std::vector<RequestWs *> & requests, std::vector<t_req_id> & ids )
+{
+
+	const std::lock_guard<t_mutex> lock( m_sendSync );
+
+	ids.clear();
+
+	if ( requests.size() > 1 ) {
+		cork( 1 );
+	}
+
+	for ( auto * r : requests ) {
+		ids.push_back( sendLocked( *r ) );
+	}
+
+	// frames queued behind the first one are written by the client loop
+	if ( requests.size() > 1 ) {
+		Post( [this]() { cork( 0 ); } );
+	}
+}
+
+void ConnectorWs::cork( int value )
+{
+	if ( m_socketFd >= 0 ) {
+		setsockopt( m_socketFd, IPPROTO_TCP, TCP_CORK, &value, sizeof( value ) );
+	}
+}
 
+zubr::t_req_id ConnectorWs::sendLocked( RequestWs & r )
+{
 	r.Id( ++m_reqId );
 	t_req_id result = m_reqId;
 
-	{
-		const std::lock_guard<std::mutex> lock( m_reqMapSync );
-		m_reqMap[result] = r;
+	if ( ResponseType::_undef != r.ExpectedResponseType() ) {
+		m_pendingRequests.Add( result, r.ExpectedResponseType() );
 	}
 
 	if ( m_reqId == std::numeric_limits<t_req_id>::max() ) {
 		m_reqId = 0;
 	}
 
-	std::string req;
-	RequestWs::Serialize( req, *m_serializerFactory.Create(), r );
+	m_encoder->Clear();
+	RequestWs::Serialize( m_sendBuffer, *m_encoder, r );
 
-	ZUBR_LOG_DEBUG( req );
+	ZUBR_LOG_DEBUG( m_sendBuffer );
 
 	std::error_code ec;
-	m_client.send(
-		m_connection->get_handle(), req, websocketpp::frame::opcode::text, ec );
+	m_client.send( m_connection->get_handle(),
+		m_sendBuffer,
+		websocketpp::frame::opcode::text,
+		ec );
 
 	return result;
 }
 
+void ConnectorWs::SetTimer(
+	long milliseconds, const std::function<void()> & handler )
+{
+
+	m_client.set_timer(
+		milliseconds, [handler]( const websocketpp::lib::error_code & ec ) {
+			if ( !ec ) {
+				handler();
+			}
+		} );
+}
+
+void ConnectorWs::Post( const std::function<void()> & handler )
+{
+	m_client.get_io_service().post( handler );
+}
+
 void ConnectorWs::Start()
 {
 	try {
@@ -169,11 +500,7 @@ void ConnectorWs::Start()
 				this,
 				websocketpp::lib::placeholders::_1 ) );
 
-		m_client.set_message_handler(
-			websocketpp::lib::bind( &ConnectorWs::OnWsMessage,
-				this,
-				websocketpp::lib::placeholders::_1,
-				websocketpp::lib::placeholders::_2 ) );
+		bindMessageHandler();
 
 		m_client.set_tls_init_handler(
 			websocketpp::lib::bind( &ConnectorWs::OnWsTlsInit,
@@ -186,43 +513,59 @@ void ConnectorWs::Start()
 				this,
 				websocketpp::lib::placeholders::_1 ) );
 
+		m_client.set_close_handler(
+			websocketpp::lib::bind( &ConnectorWs::OnWsClose,
+				this,
+				websocketpp::lib::placeholders::_1 ) );
+
+		m_client.set_tcp_post_init_handler(
+			websocketpp::lib::bind( &ConnectorWs::OnWsTcpPostInit,
+				this,
+				websocketpp::lib::placeholders::_1 ) );
+
+		m_client.set_socket_init_handler(
+			websocketpp::lib::bind( &ConnectorWs::OnWsSocketInit,
+				this,
+				websocketpp::lib::placeholders::_1,
+				websocketpp::lib::placeholders::_2 ) );
+
 		m_isRunning.test_and_set();
 
 		m_clientThread = std::thread( [this] {
+			applyClientThreadOptions();
+
 			while ( m_isRunning.test_and_set() ) {
+				if ( m_reconnectAttempt > 0 ) {
+					auto delay = reconnectDelay();
+
+					ZUBR_LOG_INFO( "reconnect in " << delay << " ms" );
+
+					std::this_thread::sleep_for(
+						std::chrono::milliseconds( delay ) );
+				}
+
+				++m_reconnectAttempt;
+
 				websocketpp::lib::error_code ec;
 
 				{
-					const std::lock_guard<std::mutex> lock( m_sendSync );
+					const std::lock_guard<t_mutex> lock( m_sendSync );
 
 					m_connection = m_client.get_connection( m_endpoint, ec );
 
 					if ( !m_connection || ec ) {
 						ZUBR_LOG_ERROR( ec.message() );
-
-						std::this_thread::sleep_for(
-							std::chrono::seconds( 2 ) );
-
 						continue;
 					}
 
 					m_client.connect( m_connection );
 				}
 
-				m_client.run();
-			}
-
-			m_isRunning.clear();
-		} );
-
-		m_pingThread = std::thread( [this] {
-			while ( m_isRunning.test_and_set() ) {
-				std::this_thread::sleep_for( std::chrono::seconds( 14 ) );
+				runClientLoop();
 
-				{
-					const std::lock_guard<std::mutex> lock( m_sendSync );
-					m_client.ping( m_connection, "zubrobot-ws" );
-				}
+				// the loop stopped when it ran out of work, ready it for the
+				// next connection
+				m_client.reset();
 			}
 
 			m_isRunning.clear();
@@ -233,6 +576,27 @@ void ConnectorWs::Start()
 	}
 }
 
+void ConnectorWs::Stop()
+{
+	m_isRunning.clear();
+
+	if ( !m_clientThread.joinable() ) {
+		return;
+	}
+
+	Post( [this]() {
+		stopConnectionTimers();
+
+		if ( m_connection ) {
+			websocketpp::lib::error_code ec;
+			m_client.close( m_connection->get_handle(),
+				websocketpp::close::status::normal,
+				"stop",
+				ec );
+		}
+	} );
+}
+
 void ConnectorWs::Wait()
 {
 	if ( m_clientThread.joinable() ) {
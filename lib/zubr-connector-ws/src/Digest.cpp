@@ -27,34 +27,91 @@ SOFTWARE.
 /// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
 ///
 
-#include <iostream>
-#include <sstream>
+#include <string>
 
 #include "openssl/hmac.h"
 #include "openssl/sha.h"
 
+#include "zubr-core/Exception.hpp"
+#include "zubr-core/Logger.hpp"
+
 #include "../include/zubr-connector-ws/Digest.hpp"
 
 
 using namespace zubr;
 
 
-void Digest::FromHex( std::vector<uint8_t> & out, const std::string & hex )
+Digest::Digest( const std::string & keyId, const std::string & keySecretHex )
+	: m_keyId( keyId )
+	, m_messagePrefix( "key=" + keyId + ";time=" )
 {
-	std::string token;
 
-	if ( ( hex.length() & 1 ) != 0 ) {
-		token.append( "0" );
+	// a wrong key would only show as an authentication failure
+	if ( !FromHex( m_key, keySecretHex ) ) {
+		ZUBR_LOG_ERROR( "API key secret of " << keyId << " is not hex" );
+		throw zubr::Exception();
+	}
+}
+
+void Digest::Calculate( std::string & out, uint64_t ts ) const
+{
+	std::string msg( m_messagePrefix );
+	msg.append( std::to_string( ts ) );
+
+	uint8_t buffer[EVP_MAX_MD_SIZE];
+	unsigned bufferLen;
+	HMAC( EVP_sha256(),
+		m_key.data(),
+		m_key.size(),
+		reinterpret_cast<const unsigned char *>( msg.c_str() ),
+		msg.length(),
+		buffer,
+		&bufferLen );
+
+	ToHex( out, buffer, bufferLen );
+}
+
+/// @return -1 if not a hex digit
+static int fromHexDigit( char c )
+{
+	if ( c >= '0' && c <= '9' ) {
+		return c - '0';
+	}
+
+	if ( c >= 'a' && c <= 'f' ) {
+		return c - 'a' + 10;
+	}
+
+	if ( c >= 'A' && c <= 'F' ) {
+		return c - 'A' + 10;
 	}
 
-	for ( size_t i = 0; i < hex.length(); ++i ) {
-		token += hex[i];
+	return -1;
+}
 
-		if ( token.length() == 2 ) {
-			out.push_back( std::stoul( token, 0, 16 ) );
-			token.clear();
+bool Digest::FromHex( std::vector<uint8_t> & out, const std::string & hex )
+{
+	for ( char c : hex ) {
+		if ( fromHexDigit( c ) < 0 ) {
+			return false;
 		}
 	}
+
+	size_t i = 0;
+	out.reserve( out.size() + ( hex.length() + 1 ) / 2 );
+
+	// odd length - leading digit is a whole byte
+	if ( ( hex.length() & 1 ) != 0 ) {
+		out.push_back( fromHexDigit( hex[0] ) );
+		i = 1;
+	}
+
+	for ( ; i < hex.length(); i += 2 ) {
+		out.push_back(
+			( fromHexDigit( hex[i] ) << 4 ) | fromHexDigit( hex[i + 1] ) );
+	}
+
+	return true;
 }
 
 void Digest::ToHex( std::string & out, uint8_t * buffer, size_t bufferLen )
@@ -75,24 +132,5 @@ void Digest::Calculate( std::string & out,
 	const std::string & keySecretHex,
 	uint64_t ts )
 {
-	std::stringstream ss;
-	ss << "key=" << keyId << ";"
-	   << "time=" << ts;
-
-	std::string msg = ss.str();
-
-	std::vector<uint8_t> keySecret;
-	FromHex( keySecret, keySecretHex );
-
-	uint8_t buffer[EVP_MAX_MD_SIZE];
-	unsigned bufferLen;
-	HMAC( EVP_sha256(),
-		keySecret.data(),
-		keySecret.size(),
-		reinterpret_cast<const unsigned char *>( msg.c_str() ),
-		msg.length(),
-		buffer,
-		&bufferLen );
-
-	ToHex( out, buffer, bufferLen );
+	Digest( keyId, keySecretHex ).Calculate( out, ts );
 }
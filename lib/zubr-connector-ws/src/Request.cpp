@@ -30,22 +30,12 @@ SOFTWARE.
 #include <chrono>
 #include <iostream>
 
-#include "../include/zubr-connector-ws/Digest.hpp"
-
 #include "../include/zubr-connector-ws/Request.hpp"
 
 
 using namespace zubr;
 
 
-const std::string zubr::AuthRequestWs::ReqMethodName(
-	"loginSessionByApiToken" );
-
-const std::string zubr::PlaceOrderRequestWs::ReqMethodName( "placeOrder" );
-const std::string zubr::ReplaceOrderRequestWs::ReqMethodName( "replaceOrder" );
-const std::string zubr::CancelOrderRequestWs::ReqMethodName( "cancelOrder" );
-
-
 void RequestWs::Serialize( std::string & out, Serializer & s, RequestWs & req )
 {
 	req.SerializeBase( s );
@@ -75,10 +65,10 @@ void AuthRequestWs::Serialize( Serializer & s )
 
 	auto now = Time::Now();
 	params->Serialize( now, "time" );
-	params->Serialize( m_keyId, "apiKey" );
+	params->Serialize( m_digest.KeyId(), "apiKey" );
 
 	std::string digest;
-	Digest::Calculate( digest, m_keyId, m_keySecret, now.Seconds() );
+	m_digest.Calculate( digest, now.Seconds() );
 	params->Serialize( digest, "hmacDigest" );
 }
 
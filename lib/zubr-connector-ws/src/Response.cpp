@@ -27,6 +27,8 @@ SOFTWARE.
 /// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
 ///
 
+#include <charconv>
+
 #include "rapidjson/document.h"
 
 #include "../include/zubr-connector-ws/Response.hpp"
@@ -35,13 +37,32 @@ SOFTWARE.
 using namespace zubr;
 
 
-std::shared_ptr<ResponseWs> ResponseWs::Deserialize( Serializer & s,
+template <typename TResponse>
+ResponseRef ResponseWs::deserialize(
+	TResponse & res, t_req_id id, InstrumentFilter * filter, Serializer & s )
+{
+
+	res.m_id = id;
+	res.m_filter = filter;
+
+	auto value = res.deserializeStatus( s );
+
+	if ( value ) {
+		res.TResponse::Deserialize( *value );
+	}
+
+	return &res;
+}
+
+ResponseRef ResponseWs::Deserialize( Serializer & s,
 	const std::string & in,
-	const std::function<ResponseType( t_req_id id )> & typeResolver )
+	const PendingRequests & pending,
+	ResponsePool & pool,
+	InstrumentFilter * filter )
 {
 
 	if ( in.empty() ) {
-		return std::make_shared<ResponseWs>( ResponseType::_undef );
+		return &pool.Get<ResponseWs>();
 	}
 
 	s.FromString( in );
@@ -50,88 +71,100 @@ std::shared_ptr<ResponseWs> ResponseWs::Deserialize( Serializer & s,
 	s.Deserialize( id, "id" );
 	auto resResult = s.GetObject( "result" );
 
-	std::string channelName;
+	std::string_view channelName;
 	resResult->Deserialize( channelName, "channel" );
 
-	std::shared_ptr<ResponseWs> result;
-
 	if ( !channelName.empty() ) {
 		auto channel = ChannelEnumHelper::FromChannelName( channelName );
 
 		switch ( channel ) {
 			case Channel::OrderBook:
-				result.reset( new ChannelOrderBookResponseWs );
-
-				break;
+				return deserialize( pool.Get<ChannelOrderBookResponseWs>(),
+					id,
+					filter,
+					*resResult );
 
 			case Channel::Orders:
-				result.reset( new ChannelOrdersResponseWs );
+				return deserialize(
+					pool.Get<ChannelOrdersResponseWs>(), id, filter, *resResult );
 
-				break;
+			case Channel::OrderFills:
+				return deserialize( pool.Get<ChannelOrderFillsResponseWs>(),
+					id,
+					filter,
+					*resResult );
 
-			case Channel::Positions:
-				result.reset( new ChannelPositionsResponseWs );
+			case Channel::LastTrades:
+				return deserialize( pool.Get<ChannelLastTradesResponseWs>(),
+					id,
+					filter,
+					*resResult );
 
-				break;
+			case Channel::Positions:
+				return deserialize( pool.Get<ChannelPositionsResponseWs>(),
+					id,
+					filter,
+					*resResult );
 
 			case Channel::Instruments:
-				result.reset( new ChannelInstrumentsResponseWs );
+				return deserialize( pool.Get<ChannelInstrumentsResponseWs>(),
+					id,
+					filter,
+					*resResult );
 
+			default:
+				// not subscribed to
 				break;
 		}
 	}
 
-	if ( !result ) {
-		auto type = typeResolver( id );
+	switch ( pending.Find( id ) ) {
+		case ResponseType::Auth:
+			return deserialize(
+				pool.Get<AuthResponseWs>(), id, filter, *resResult );
 
-		switch ( type ) {
-			case ResponseType::Auth:
-				result.reset( new AuthResponseWs );
-				break;
-
-			case ResponseType::PlaceOrder:
-				result.reset( new PlaceOrderResponseWs );
-				break;
-		}
-	}
+		case ResponseType::PlaceOrder:
+			return deserialize(
+				pool.Get<PlaceOrderResponseWs>(), id, filter, *resResult );
 
-	if ( !result ) {
-		result.reset( new ResponseWs( ResponseType::_undef ) );
+		default:
+			// cancel and subscribe requests are not tracked, their status
+			// is all there is to decode
+			break;
 	}
 
-	result->m_id = id;
-	result->Deserialize( result, *resResult );
-
-	return result;
+	return deserialize( pool.Get<ResponseWs>(), id, filter, *resResult );
 }
 
-void ResponseWs::Deserialize(
-	const std::shared_ptr<ResponseWs> & out, Serializer & s )
+std::shared_ptr<Serializer> ResponseWs::deserializeStatus( Serializer & s )
 {
-
 	auto data = s.GetObject( "data" );
 	Serializer & s_ = data ? *data : s;
 
-	std::string stringValue;
-	s_.Deserialize( stringValue, "tag" );
+	std::string_view tag;
+	s_.Deserialize( tag, "tag" );
 
-	if ( "ok" == stringValue ) {
-		m_isOk = true;
-	}
-	else if ( "err" == stringValue ) {
-		m_isOk = false;
+	switch ( ChannelEnumHelper::FromResultTagName( tag ) ) {
+		case ResultTag::Ok:
+			m_isOk = true;
+			break;
+
+		case ResultTag::Err:
+			m_isOk = false;
+			break;
+
+		default:
+			break;
 	}
 
 	auto value = s_.GetObject( "value" );
 
-	if ( value ) {
-		if ( m_isOk ) {
-			Deserialize( *value );
-		}
-		else {
-			value->Deserialize( m_errorCodeName, "code" );
-		}
+	if ( value && !m_isOk ) {
+		value->Deserialize( m_errorCodeName, "code" );
+		value.reset();
 	}
+
+	return value;
 }
 
 
@@ -143,48 +176,145 @@ void AuthResponseWs::Deserialize( Serializer & s )
 
 void PlaceOrderResponseWs::Deserialize( Serializer & s )
 {
-	std::string stringValue;
+	std::string_view stringValue;
 	s.Deserialize( stringValue );
-	m_orderId = std::stoll( stringValue );
+
+	std::from_chars(
+		stringValue.data(), stringValue.data() + stringValue.size(), m_orderId );
 }
 
 
 void ChannelOrdersResponseWs::Deserialize( Serializer & s )
 {
-	std::string stringValue;
+	std::string_view stringValue;
 
 	s.Deserialize( stringValue, "type" );
+	auto type = ChannelEnumHelper::FromMessageTypeName( stringValue );
 
-	if ( "update" == stringValue ) {
+	if ( ChannelMessageType::Update == type ) {
 		OrderEntry entry;
 		s.Deserialize( entry, "payload" );
 
-		m_entries[entry.Id()] = entry;
+		m_entries.Acquire( entry.Id() ) = entry;
+	}
+	else if ( ChannelMessageType::Snapshot == type ) {
+		m_isSnapshot = true;
+
+		auto s_ = s.GetObject( "payload" );
+
+		// empty snapshot - no open orders
+		if ( s_ ) {
+			s_->Deserialize(
+				[this]( Serializer & s, const std::string & ) {
+					OrderEntry entry;
+					entry.Deserialize( s );
+
+					m_entries.Acquire( entry.Id() ) = entry;
+				},
+				"" );
+		}
+	}
+}
+
+
+void ChannelOrderFillsResponseWs::Deserialize( Serializer & s )
+{
+	std::string_view stringValue;
+
+	s.Deserialize( stringValue, "type" );
+	auto type = ChannelEnumHelper::FromMessageTypeName( stringValue );
+
+	if ( ChannelMessageType::Update == type ) {
+		OrderFill fill;
+		s.Deserialize( fill, "payload" );
+
+		m_entries.Acquire( fill.Id() ) = fill;
+	}
+	else if ( ChannelMessageType::Snapshot == type ) {
+		m_isSnapshot = true;
+	}
+}
+
+
+void ChannelLastTradesResponseWs::add( Serializer & s )
+{
+	int instrumentId;
+	s.Deserialize( instrumentId, "instrumentId" );
+
+	if ( m_filter && !( *m_filter )( instrumentId ) ) {
+		return;
+	}
+
+	t_order_id id;
+	s.Deserialize( id, "id" );
+
+	m_entries.Acquire( id ).Deserialize( s );
+}
+
+void ChannelLastTradesResponseWs::Deserialize( Serializer & s )
+{
+	std::string_view stringValue;
+
+	s.Deserialize( stringValue, "type" );
+	auto type = ChannelEnumHelper::FromMessageTypeName( stringValue );
+
+	auto s_ = s.GetObject( "payload" );
+
+	if ( !s_ ) {
+		return;
+	}
+
+	if ( ChannelMessageType::Update == type ) {
+		add( *s_ );
+	}
+	else if ( ChannelMessageType::Snapshot == type ) {
+		m_isSnapshot = true;
+
+		s_->Deserialize(
+			[this]( Serializer & s, const std::string & ) { add( s ); }, "" );
 	}
 }
 
 
 void ChannelOrderBookResponseWs::Deserialize( Serializer & s )
 {
-	s.Deserialize( m_entries );
+	if ( m_filter ) {
+		s.Deserialize( m_entries, *m_filter );
+	}
+	else {
+		s.Deserialize( m_entries );
+	}
 }
 
 
 void ChannelPositionsResponseWs::Deserialize( Serializer & s )
 {
-	std::string stringValue;
+	std::string_view stringValue;
 
 	s.Deserialize( stringValue, "type" );
+	auto type = ChannelEnumHelper::FromMessageTypeName( stringValue );
 
-	if ( "update" == stringValue ) {
+	if ( ChannelMessageType::Update == type ) {
 		Position p;
 		s.Deserialize( p, "payload" );
 
-		m_entries[p.InstrumentId()] = p;
+		m_entries.Acquire( p.InstrumentId() ) = p;
 	}
-	else if ( "snapshot" == stringValue ) {
+	else if ( ChannelMessageType::Snapshot == type ) {
+		m_isSnapshot = true;
+
 		auto s_ = s.GetObject( "payload" );
-		s_->Deserialize( m_entries );
+
+		if ( !s_ ) {
+			return;
+		}
+
+		if ( m_filter ) {
+			s_->Deserialize( m_entries, *m_filter );
+		}
+		else {
+			s_->Deserialize( m_entries );
+		}
 	}
 }
 
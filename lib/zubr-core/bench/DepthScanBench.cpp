@@ -0,0 +1,172 @@
+/*
+MIT License
+
+Copyright (c) 2020 Denis Rozhkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// DepthScanBench.cpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "zubr-core/DepthScan.hpp"
+
+
+using namespace zubr;
+
+
+namespace {
+
+	typedef std::chrono::steady_clock t_clock;
+
+	/// @brief outputs of every scan over one book
+	struct scanResult {
+		std::vector<int64_t> prefix;
+		std::vector<size_t> index;
+		std::vector<int64_t> cumulative;
+		int64_t sum;
+		int64_t weightedSum;
+
+		bool operator==( const scanResult & r ) const
+		{
+			return ( prefix == r.prefix && index == r.index
+				&& cumulative == r.cumulative && sum == r.sum
+				&& weightedSum == r.weightedSum );
+		}
+	};
+
+	scanResult scan( const std::vector<int64_t> & book,
+		const std::vector<int64_t> & thresholds )
+	{
+
+		scanResult result;
+		result.prefix.resize( book.size() );
+		DepthScan::PrefixSum( book.data(), result.prefix.data(), book.size() );
+
+		for ( auto threshold : thresholds ) {
+			int64_t sum;
+			result.index.push_back( DepthScan::FindCumulative(
+				book.data(), book.size(), threshold, sum ) );
+
+			result.cumulative.push_back( sum );
+		}
+
+		DepthScan::WeightedSum(
+			book.data(), book.size(), result.sum, result.weightedSum );
+
+		return result;
+	}
+
+	/// @brief average nanoseconds per call
+	template <typename TCall> double measure( int iterations, TCall && call )
+	{
+		auto startedAt = t_clock::now();
+
+		for ( int i = 0; i < iterations; ++i ) {
+			call();
+		}
+
+		return std::chrono::duration<double, std::nano>(
+				   t_clock::now() - startedAt )
+				   .count()
+			/ iterations;
+	}
+
+} // namespace
+
+
+int main( int argc, char * argv[] )
+{
+	size_t levels = argc > 1 ? std::strtoul( argv[1], nullptr, 10 ) : 256;
+	int iterations = argc > 2 ? std::atoi( argv[2] ) : 1000000;
+
+	if ( 0 == levels || iterations <= 0 ) {
+		std::cout << argv[0] << ": [levels] [iterations]" << std::endl;
+		return -1;
+	}
+
+	// quantities fit in 32 bits as WeightedSum requires
+	std::mt19937_64 random( 42 );
+	std::uniform_int_distribution<int64_t> quantity( 1, 1000000 );
+
+	std::vector<int64_t> book( levels );
+	int64_t total = 0;
+
+	for ( auto & q : book ) {
+		q = quantity( random );
+		total += q;
+	}
+
+	// reached at the top, in the middle, at the last level and never
+	std::vector<int64_t> thresholds = { 1, total / 2, total, total + 1 };
+
+	std::vector<int64_t> out( levels );
+	volatile int64_t sink = 0;
+	scanResult reference;
+	int rc = 0;
+
+	for ( auto isa : { "scalar", "sse2", "avx2" } ) {
+		if ( !DepthScan::Select( isa ) ) {
+			std::cout << isa << ": not supported" << std::endl;
+			continue;
+		}
+
+		auto result = scan( book, thresholds );
+
+		if ( reference.prefix.empty() ) {
+			reference = result;
+		}
+		else if ( !( result == reference ) ) {
+			std::cout << isa << ": results differ from scalar" << std::endl;
+			rc = 1;
+		}
+
+		auto prefixNs = measure( iterations, [&]() {
+			DepthScan::PrefixSum( book.data(), out.data(), levels );
+			sink = out[levels - 1];
+		} );
+
+		auto findNs = measure( iterations, [&]() {
+			int64_t sum;
+			sink = DepthScan::FindCumulative(
+				book.data(), levels, total / 2, sum );
+		} );
+
+		auto weightedNs = measure( iterations, [&]() {
+			int64_t sum;
+			int64_t weightedSum;
+			DepthScan::WeightedSum( book.data(), levels, sum, weightedSum );
+			sink = weightedSum;
+		} );
+
+		std::cout << isa << ": " << levels << " levels, PrefixSum "
+				  << prefixNs << " ns, FindCumulative " << findNs
+				  << " ns, WeightedSum " << weightedNs << " ns" << std::endl;
+	}
+
+	return rc;
+}
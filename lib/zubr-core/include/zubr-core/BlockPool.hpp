@@ -0,0 +1,248 @@
+/*
+MIT License
+
+Copyright (c) 2020 Denis Rozhkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// BlockPool.hpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#ifndef __ZUBR_BLOCK_POOL__H
+#define __ZUBR_BLOCK_POOL__H
+
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+
+
+namespace zubr {
+
+	/// @brief fixed number of equally sized blocks allocated once; a free
+	/// block holds the index of the next one (intrusive free list), the list
+	/// head is a lock-free stack tagged against ABA, so blocks may be taken
+	/// and returned on different threads
+	class BlockPool {
+	public:
+		static constexpr size_t BlockAlignment = alignof( std::max_align_t );
+
+	protected:
+		typedef std::atomic<uint32_t> t_link;
+
+		static constexpr uint32_t Nil = UINT32_MAX;
+
+		size_t m_blockSize;
+		uint32_t m_blockCount;
+		std::unique_ptr<unsigned char[]> m_blocks;
+
+		/// @brief tag << 32 | index of the first free block
+		std::atomic<uint64_t> m_head;
+		std::atomic<size_t> m_fallbackCount;
+
+	protected:
+		unsigned char * block( uint32_t index ) const
+		{
+			return m_blocks.get() + index * m_blockSize;
+		}
+
+		t_link & link( uint32_t index ) const
+		{
+			return *reinterpret_cast<t_link *>( block( index ) );
+		}
+
+		static uint64_t head( uint64_t previous, uint32_t index )
+		{
+			return ( ( ( previous >> 32 ) + 1 ) << 32 ) | index;
+		}
+
+	public:
+		/// @brief pool of blockCount blocks of at least blockSize bytes
+		/// @param blockSize
+		/// @param blockCount
+		BlockPool( size_t blockSize, uint32_t blockCount )
+			: m_blockSize( ( std::max( blockSize, sizeof( t_link ) )
+								 + BlockAlignment - 1 )
+				  & ~( BlockAlignment - 1 ) )
+			, m_blockCount( blockCount )
+			, m_blocks( new unsigned char[m_blockSize * blockCount] )
+			, m_head( 0 == blockCount ? Nil : 0 )
+			, m_fallbackCount( 0 )
+		{
+
+			for ( uint32_t i = 0; i < blockCount; ++i ) {
+				new ( block( i ) )
+					t_link( i + 1 < blockCount ? i + 1 : Nil );
+			}
+		}
+
+		BlockPool( const BlockPool & ) = delete;
+		BlockPool & operator=( const BlockPool & ) = delete;
+
+		/// @brief take a free block
+		/// @return nullptr if the pool is exhausted
+		void * Allocate()
+		{
+			auto current = m_head.load( std::memory_order_acquire );
+
+			for ( ;; ) {
+				auto index = static_cast<uint32_t>( current );
+
+				if ( Nil == index ) {
+					return nullptr;
+				}
+
+				// the block may be taken by another thread meanwhile, the
+				// tag fails the exchange then
+				auto next = link( index ).load( std::memory_order_relaxed );
+
+				if ( m_head.compare_exchange_weak( current,
+						 head( current, next ),
+						 std::memory_order_acquire,
+						 std::memory_order_acquire ) ) {
+
+					return block( index );
+				}
+			}
+		}
+
+		/// @brief return a block taken by Allocate
+		/// @param p
+		void Release( void * p )
+		{
+			auto index = static_cast<uint32_t>(
+				( static_cast<unsigned char *>( p ) - m_blocks.get() )
+				/ m_blockSize );
+
+			auto * next = new ( p ) t_link( Nil );
+			auto current = m_head.load( std::memory_order_relaxed );
+
+			do {
+				next->store(
+					static_cast<uint32_t>( current ), std::memory_order_relaxed );
+			} while ( !m_head.compare_exchange_weak( current,
+				head( current, index ),
+				std::memory_order_release,
+				std::memory_order_relaxed ) );
+		}
+
+		/// @brief whether the block belongs to the pool
+		/// @param p
+		/// @return
+		bool Owns( const void * p ) const
+		{
+			auto * b = static_cast<const unsigned char *>( p );
+
+			return ( b >= m_blocks.get()
+				&& b < m_blocks.get() + m_blockSize * m_blockCount );
+		}
+
+		size_t BlockSize() const
+		{
+			return m_blockSize;
+		}
+
+		/// @brief note an allocation the pool could not serve
+		void OnFallback()
+		{
+			m_fallbackCount.fetch_add( 1, std::memory_order_relaxed );
+		}
+
+		/// @brief number of allocations served by the heap since the pool
+		/// was created
+		/// @return
+		size_t FallbackCount() const
+		{
+			return m_fallbackCount.load( std::memory_order_relaxed );
+		}
+	};
+
+	/// @brief allocator taking single objects from a block pool, falls back
+	/// to the heap for arrays, oversized objects or an exhausted pool; with
+	/// std::allocate_shared the object and its control block share a block
+	/// @tparam T
+	template <typename T> class PoolAllocator {
+	protected:
+		template <typename U> friend class PoolAllocator;
+
+		BlockPool * m_pool;
+
+	public:
+		typedef T value_type;
+
+		explicit PoolAllocator( BlockPool & pool )
+			: m_pool( &pool )
+		{
+		}
+
+		template <typename U>
+		PoolAllocator( const PoolAllocator<U> & r )
+			: m_pool( r.m_pool )
+		{
+		}
+
+		T * allocate( size_t n )
+		{
+			if ( 1 == n && sizeof( T ) <= m_pool->BlockSize()
+				&& alignof( T ) <= BlockPool::BlockAlignment ) {
+
+				auto * p = m_pool->Allocate();
+
+				if ( nullptr != p ) {
+					return static_cast<T *>( p );
+				}
+			}
+
+			m_pool->OnFallback();
+
+			return static_cast<T *>( ::operator new( n * sizeof( T ) ) );
+		}
+
+		void deallocate( T * p, size_t n )
+		{
+			if ( m_pool->Owns( p ) ) {
+				m_pool->Release( p );
+			}
+			else {
+				// size of the fallback allocation
+				::operator delete( p, n * sizeof( T ) );
+			}
+		}
+
+		template <typename U> bool operator==( const PoolAllocator<U> & r ) const
+		{
+			return ( m_pool == r.m_pool );
+		}
+
+		template <typename U> bool operator!=( const PoolAllocator<U> & r ) const
+		{
+			return ( m_pool != r.m_pool );
+		}
+	};
+
+} // namespace zubr
+
+
+#endif
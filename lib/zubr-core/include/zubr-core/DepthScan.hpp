@@ -0,0 +1,84 @@
+/*
+MIT License
+
+Copyright (c) 2020 Denis Rozhkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// DepthScan.hpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#ifndef __ZUBR_DEPTH_SCAN__H
+#define __ZUBR_DEPTH_SCAN__H
+
+
+#include <cstddef>
+#include <cstdint>
+
+
+namespace zubr {
+
+	/// @brief scans over contiguous level quantity arrays, vectorized
+	/// (AVX2, SSE2) with a scalar fallback, the implementation is selected
+	/// once by the CPU features available at run time
+	class DepthScan {
+	public:
+		/// @brief out[i] = in[0] + ... + in[i], out may be in
+		static void PrefixSum( const int64_t * in, int64_t * out, size_t n );
+
+		/// @brief first index at which the running sum reaches threshold
+		/// @param q
+		/// @param n
+		/// @param threshold
+		/// @param sum running sum up to and including the index, the total
+		/// if not reached
+		/// @return index, n if not reached
+		static size_t FindCumulative( const int64_t * q,
+			size_t n,
+			int64_t threshold,
+			int64_t & sum );
+
+		/// @brief sum of q[i] and of q[i] * i, q[i] and n are to fit in 32
+		/// bits
+		/// @param q
+		/// @param n
+		/// @param sum
+		/// @param weightedSum
+		static void WeightedSum( const int64_t * q,
+			size_t n,
+			int64_t & sum,
+			int64_t & weightedSum );
+
+		/// @brief name of the selected implementation
+		static const char * Isa();
+
+		/// @brief replace the selected implementation, not thread safe,
+		/// for benchmarks and checks
+		/// @param isa "avx2", "sse2" or "scalar"
+		/// @return false if not supported by the CPU
+		static bool Select( const char * isa );
+	};
+
+} // namespace zubr
+
+
+#endif
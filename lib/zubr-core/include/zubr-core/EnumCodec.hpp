@@ -0,0 +1,152 @@
+/*
+MIT License
+
+Copyright (c) 2020 Denis Rozhkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// EnumCodec.hpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#ifndef __ZUBR_ENUM_CODEC__H
+#define __ZUBR_ENUM_CODEC__H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+
+namespace zubr {
+
+	/// @brief protocol name of an enum value
+	template <typename TEnum> struct EnumName {
+		std::string_view name;
+		TEnum value;
+	};
+
+	/// @brief compile time enum <-> protocol name codec; names are looked up
+	/// through a perfect hash, values through a table indexed by value
+	/// @tparam TEnum enum with _undef = 0 and values 1..N
+	/// @tparam N number of named values
+	template <typename TEnum, size_t N> class EnumCodec {
+	protected:
+		static constexpr size_t tableSize()
+		{
+			size_t result = 1;
+
+			while ( result < 2 * N ) {
+				result <<= 1;
+			}
+
+			return result;
+		}
+
+		static constexpr uint32_t hash( std::string_view s, uint32_t seed )
+		{
+			// FNV-1a
+			uint32_t result = 2166136261u ^ seed;
+
+			for ( auto c : s ) {
+				result ^= static_cast<uint8_t>( c );
+				result *= 16777619u;
+			}
+
+			return result;
+		}
+
+	protected:
+		EnumName<TEnum> m_entries[N];
+		// entry index + 1, 0 - empty slot
+		uint8_t m_slots[tableSize()];
+		// names by enum value
+		std::string_view m_names[N + 1];
+		uint32_t m_seed;
+
+	public:
+		/// @brief build codec
+		/// @param entries names, string literals only (ToString returns
+		/// zero terminated data)
+		constexpr EnumCodec( const EnumName<TEnum> ( &entries )[N] )
+			: m_entries{}
+			, m_slots{}
+			, m_names{}
+			, m_seed( 0 )
+		{
+
+			for ( size_t i = 0; i < N; ++i ) {
+				auto value = static_cast<size_t>( entries[i].value );
+
+				if ( value < 1 || value > N ) {
+					throw "enum value out of range";
+				}
+
+				m_entries[i] = entries[i];
+				m_names[value] = entries[i].name;
+			}
+
+			for ( bool isPerfect = false; !isPerfect; ) {
+				isPerfect = true;
+
+				for ( size_t i = 0; i < tableSize(); ++i ) {
+					m_slots[i] = 0;
+				}
+
+				for ( size_t i = 0; i < N && isPerfect; ++i ) {
+					auto & slot = m_slots[hash( entries[i].name, m_seed )
+										  & ( tableSize() - 1 )];
+
+					if ( slot != 0 ) {
+						isPerfect = false;
+						++m_seed;
+					}
+					else {
+						slot = i + 1;
+					}
+				}
+			}
+		}
+
+		/// @brief enum value by name, _undef if unknown
+		constexpr TEnum FromString( std::string_view name ) const
+		{
+			auto slot = m_slots[hash( name, m_seed ) & ( tableSize() - 1 )];
+
+			return ( slot != 0 && m_entries[slot - 1].name == name
+						 ? m_entries[slot - 1].value
+						 : TEnum::_undef );
+		}
+
+		/// @brief name of enum value, "N/A" if unnamed
+		constexpr const char * ToString( TEnum value ) const
+		{
+			auto i = static_cast<size_t>( value );
+
+			return ( i <= N && !m_names[i].empty() ? m_names[i].data()
+												   : "N/A" );
+		}
+	};
+
+} // namespace zubr
+
+
+#endif
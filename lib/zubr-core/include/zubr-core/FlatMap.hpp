@@ -0,0 +1,321 @@
+/*
+MIT License
+
+Copyright (c) 2020 Denis Rozhkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// FlatMap.hpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#ifndef __ZUBR_FLAT_MAP__H
+#define __ZUBR_FLAT_MAP__H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+
+namespace zubr {
+
+	/// @brief open addressing hash table of integer keys with the values
+	/// stored inline, linear probing with backward shift deletion (no
+	/// tombstones), slots are padded to a power of two so none straddles
+	/// a cache line
+	/// @tparam TKey integer key
+	/// @tparam TValue
+	/// @tparam EmptyKey marks a free slot, never to be used as a key
+	template <typename TKey,
+		typename TValue,
+		TKey EmptyKey = std::numeric_limits<TKey>::min()>
+	class FlatMap {
+	protected:
+		static constexpr size_t slotAlignment( size_t size )
+		{
+			size_t result = alignof( std::pair<TKey, TValue> );
+
+			while ( result < size && result < 64 ) {
+				result <<= 1;
+			}
+
+			return result;
+		}
+
+	public:
+		struct alignas( slotAlignment(
+			sizeof( std::pair<TKey, TValue> ) ) ) value_type {
+			TKey first;
+			TValue second;
+		};
+
+		/// @brief forward iterator over the occupied slots
+		template <typename TSlot> class basic_iterator {
+		protected:
+			TSlot * m_slot;
+			TSlot * m_end;
+
+		protected:
+			void skipFree()
+			{
+				while ( m_slot != m_end && EmptyKey == m_slot->first ) {
+					++m_slot;
+				}
+			}
+
+		public:
+			basic_iterator( TSlot * slot, TSlot * end )
+				: m_slot( slot )
+				, m_end( end )
+			{
+				skipFree();
+			}
+
+			TSlot & operator*() const
+			{
+				return *m_slot;
+			}
+
+			TSlot * operator->() const
+			{
+				return m_slot;
+			}
+
+			basic_iterator & operator++()
+			{
+				++m_slot;
+				skipFree();
+
+				return *this;
+			}
+
+			bool operator==( const basic_iterator & r ) const
+			{
+				return ( m_slot == r.m_slot );
+			}
+
+			bool operator!=( const basic_iterator & r ) const
+			{
+				return ( m_slot != r.m_slot );
+			}
+		};
+
+		typedef basic_iterator<value_type> iterator;
+		typedef basic_iterator<const value_type> const_iterator;
+
+	protected:
+		std::vector<value_type> m_slots;
+		size_t m_mask;
+		int m_shift;
+		size_t m_size;
+
+	protected:
+		/// @brief Fibonacci hashing, sequential keys spread over the table
+		size_t home( TKey key ) const
+		{
+			return static_cast<size_t>( ( static_cast<uint64_t>( key )
+											* UINT64_C( 0x9E3779B97F4A7C15 ) )
+										>> m_shift );
+		}
+
+		/// @brief slot holding key or the free slot ending its probe
+		size_t probe( TKey key ) const
+		{
+			auto i = home( key );
+
+			while ( EmptyKey != m_slots[i].first && key != m_slots[i].first ) {
+				i = ( i + 1 ) & m_mask;
+			}
+
+			return i;
+		}
+
+		void allocate( size_t capacity )
+		{
+			size_t slots = 2;
+			m_shift = 63;
+
+			// at most half full
+			while ( slots < capacity * 2 ) {
+				slots <<= 1;
+				--m_shift;
+			}
+
+			m_slots.assign( slots, value_type{ EmptyKey, TValue() } );
+			m_mask = slots - 1;
+			m_size = 0;
+		}
+
+		void grow()
+		{
+			std::vector<value_type> slots;
+			slots.swap( m_slots );
+
+			allocate( slots.size() );
+
+			for ( auto & slot : slots ) {
+				if ( EmptyKey != slot.first ) {
+					m_slots[probe( slot.first )] = std::move( slot );
+					++m_size;
+				}
+			}
+		}
+
+	public:
+		/// @brief open addressing hash table
+		/// @param capacity entries held without rehashing
+		explicit FlatMap( size_t capacity )
+		{
+			allocate( capacity );
+		}
+
+		iterator find( TKey key )
+		{
+			auto i = probe( key );
+
+			return ( EmptyKey == m_slots[i].first
+						 ? end()
+						 : iterator( &m_slots[i], m_slots.data() + m_slots.size() ) );
+		}
+
+		const_iterator find( TKey key ) const
+		{
+			auto i = probe( key );
+
+			return ( EmptyKey == m_slots[i].first
+						 ? end()
+						 : const_iterator(
+							 &m_slots[i], m_slots.data() + m_slots.size() ) );
+		}
+
+		/// @brief value of key, default constructed if missing, references
+		/// are invalidated by the following insertion or erase
+		TValue & operator[]( TKey key )
+		{
+			auto i = probe( key );
+
+			if ( EmptyKey != m_slots[i].first ) {
+				return m_slots[i].second;
+			}
+
+			// rehash beyond the capacity, not expected in steady state
+			if ( ( m_size + 1 ) * 2 > m_slots.size() ) {
+				grow();
+				i = probe( key );
+			}
+
+			m_slots[i].first = key;
+			++m_size;
+
+			return m_slots[i].second;
+		}
+
+		/// @brief remove key, following entries of the probe sequence are
+		/// shifted back, iterators are invalidated
+		/// @return false if missing
+		bool erase( TKey key )
+		{
+			auto i = probe( key );
+
+			if ( EmptyKey == m_slots[i].first ) {
+				return false;
+			}
+
+			for ( auto j = ( i + 1 ) & m_mask;; j = ( j + 1 ) & m_mask ) {
+				if ( EmptyKey == m_slots[j].first ) {
+					break;
+				}
+
+				// an entry is moved only towards its home slot
+				if ( ( ( j - home( m_slots[j].first ) ) & m_mask )
+					 >= ( ( j - i ) & m_mask ) ) {
+
+					m_slots[i] = std::move( m_slots[j] );
+					i = j;
+				}
+			}
+
+			m_slots[i].first = EmptyKey;
+			m_slots[i].second = TValue();
+			--m_size;
+
+			return true;
+		}
+
+		iterator begin()
+		{
+			return iterator(
+				m_slots.data(), m_slots.data() + m_slots.size() );
+		}
+
+		iterator end()
+		{
+			return iterator( m_slots.data() + m_slots.size(),
+				m_slots.data() + m_slots.size() );
+		}
+
+		const_iterator begin() const
+		{
+			return const_iterator(
+				m_slots.data(), m_slots.data() + m_slots.size() );
+		}
+
+		const_iterator end() const
+		{
+			return const_iterator( m_slots.data() + m_slots.size(),
+				m_slots.data() + m_slots.size() );
+		}
+
+		size_t size() const
+		{
+			return m_size;
+		}
+
+		bool empty() const
+		{
+			return 0 == m_size;
+		}
+
+		/// @brief forget entries, slots are kept
+		void clear()
+		{
+			if ( 0 == m_size ) {
+				return;
+			}
+
+			for ( auto & slot : m_slots ) {
+				if ( EmptyKey != slot.first ) {
+					slot.first = EmptyKey;
+					slot.second = TValue();
+				}
+			}
+
+			m_size = 0;
+		}
+	};
+
+} // namespace zubr
+
+
+#endif
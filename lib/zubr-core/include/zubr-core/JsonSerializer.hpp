@@ -32,27 +32,34 @@ SOFTWARE.
 
 
 #include "rapidjson/document.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
 
 #include "Serializer.hpp"
 
 
 namespace zubr {
 
+	class JsonFrame;
+
+	typedef rapidjson::GenericDocument<rapidjson::UTF8<>,
+		rapidjson::MemoryPoolAllocator<>,
+		rapidjson::MemoryPoolAllocator<>>
+		JsonDocument;
+
 	class JsonSerializer : public Serializer {
 	protected:
-		std::shared_ptr<rapidjson::Document> m_document;
-		rapidjson::Value & m_value;
+		std::shared_ptr<JsonFrame> m_frameHolder;
+		JsonFrame * m_frame;
+		rapidjson::Value * m_value;
 
 	public:
-		JsonSerializer()
-			: m_document( new rapidjson::Document )
-			, m_value( m_document->SetObject() )
-		{
-		}
+		/// @brief root serializer of a new document
+		/// @param arenaSize bytes preallocated for the document, 0 - default
+		explicit JsonSerializer( size_t arenaSize = 0 );
 
-		JsonSerializer( const std::shared_ptr<rapidjson::Document> & document,
-			rapidjson::Value & value )
-			: m_document( document )
+		JsonSerializer( JsonFrame * frame, rapidjson::Value * value )
+			: m_frame( frame )
 			, m_value( value )
 		{
 		}
@@ -76,6 +83,10 @@ namespace zubr {
 			const std::string & memberName = "",
 			int defaultValue = -1 ) override;
 
+		Serializer & Deserialize( bool & out,
+			const std::string & memberName = "",
+			bool defaultValue = false ) override;
+
 		Serializer & Deserialize( int64_t & out,
 			const std::string & memberName = "",
 			int64_t defaultValue = INT64_C( -1 ) ) override;
@@ -84,6 +95,9 @@ namespace zubr {
 			const std::string & memberName = "",
 			const std::string & defaultValue = "" ) override;
 
+		Serializer & Deserialize( std::string_view & out,
+			const std::string & memberName = "" ) override;
+
 		Serializer & Deserialize(
 			Serializable & v, const std::string & memberName = "" ) override;
 
@@ -91,15 +105,67 @@ namespace zubr {
 									  const std::string & memberName )> & add,
 			const std::string & memberName = "" ) override;
 
+		std::shared_ptr<Serializer> Clone() override;
+
+		void Clear() override;
+
 		void ToString( std::string & out ) override;
 		void FromString( const std::string & s ) override;
 	};
 
+	/// @brief document with its memory: DOM values and parser stack are
+	/// bump-allocated from one buffer, nested serializers are recycled slots;
+	/// everything is reset by the next parse, so a reused frame stops
+	/// allocating once the buffer fits the largest message
+	class JsonFrame : public std::enable_shared_from_this<JsonFrame> {
+	protected:
+		static constexpr size_t MinArenaSize = 1024;
+		static constexpr size_t ChildrenChunkSize = 256;
+		static constexpr size_t StackCapacity = 1024;
+
+		size_t m_arenaSize;
+		size_t m_valueArenaSize;
+		std::unique_ptr<char[]> m_arena;
+
+		rapidjson::MemoryPoolAllocator<> m_valueAllocator;
+		rapidjson::MemoryPoolAllocator<> m_stackAllocator;
+		JsonDocument m_document;
+
+		std::vector<std::vector<JsonSerializer>> m_children;
+		size_t m_childrenCount;
+
+		/// @brief output buffer and writer stack keep their memory between
+		/// documents
+		rapidjson::StringBuffer m_output;
+		rapidjson::Writer<rapidjson::StringBuffer> m_writer;
+
+	public:
+		explicit JsonFrame( size_t arenaSize );
+
+		JsonDocument & Document()
+		{
+			return m_document;
+		}
+
+		/// @brief serializer of a value of the document, valid until Reset
+		/// @param value
+		/// @return shares ownership of the frame
+		std::shared_ptr<Serializer> Child( rapidjson::Value & value );
+
+		/// @brief drop the document and all children, memory is kept
+		void Reset();
+
+		/// @brief write the document
+		/// @param out
+		void Write( std::string & out );
+	};
+
 	class JsonSerializerFactory : public SerializerFactory {
 	public:
-		std::shared_ptr<Serializer> Create() const override
+		std::shared_ptr<Serializer> Create(
+			size_t arenaSize = 0 ) const override
 		{
-			return std::make_shared<JsonSerializer>();
+			return std::make_shared<JsonSerializer>( arenaSize );
 		}
 	};
 
@@ -0,0 +1,66 @@
+/*
+MIT License
+
+Copyright (c) 2020 Denis Rozhkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// Mutex.hpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#ifndef __ZUBR_MUTEX__H
+#define __ZUBR_MUTEX__H
+
+
+#include <mutex>
+
+
+namespace zubr {
+
+	/// @brief lock which does nothing, for state confined to one thread
+	class NullMutex {
+	public:
+		void lock()
+		{
+		}
+
+		void unlock()
+		{
+		}
+
+		bool try_lock()
+		{
+			return true;
+		}
+	};
+
+#ifdef ZUBR_SINGLE_THREADED
+	/// @brief everything runs on one event loop, locks compile away
+	typedef NullMutex t_mutex;
+#else
+	typedef std::mutex t_mutex;
+#endif
+
+} // namespace zubr
+
+
+#endif
@@ -0,0 +1,137 @@
+/*
+MIT License
+
+Copyright (c) 2020 Denis Rozhkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// RecyclingMap.hpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#ifndef __ZUBR_RECYCLING_MAP__H
+#define __ZUBR_RECYCLING_MAP__H
+
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+
+namespace zubr {
+
+	/// @brief small key-value container which keeps its slots on clear,
+	/// recycled values retain their own capacity (vectors, strings), so a
+	/// container refilled with messages of a similar shape stops allocating
+	/// @tparam TKey
+	/// @tparam TValue
+	template <typename TKey, typename TValue> class RecyclingMap {
+	public:
+		typedef std::pair<TKey, TValue> value_type;
+		typedef typename std::vector<value_type>::iterator iterator;
+		typedef typename std::vector<value_type>::const_iterator
+			const_iterator;
+
+	protected:
+		std::vector<value_type> m_items;
+		size_t m_size;
+
+	public:
+		RecyclingMap()
+			: m_size( 0 )
+		{
+		}
+
+		/// @brief slot for a new key, keys are expected to be unique (as
+		/// members of a decoded object are), a recycled slot holds a stale
+		/// value which the caller overwrites
+		/// @param key
+		/// @return
+		TValue & Acquire( const TKey & key )
+		{
+			if ( m_items.size() == m_size ) {
+				m_items.emplace_back();
+			}
+
+			auto & item = m_items[m_size++];
+			item.first = key;
+
+			return item.second;
+		}
+
+		iterator find( const TKey & key )
+		{
+			return std::find_if(
+				begin(), end(), [&key]( const value_type & item ) {
+					return item.first == key;
+				} );
+		}
+
+		const_iterator find( const TKey & key ) const
+		{
+			return std::find_if(
+				begin(), end(), [&key]( const value_type & item ) {
+					return item.first == key;
+				} );
+		}
+
+		iterator begin()
+		{
+			return m_items.begin();
+		}
+
+		iterator end()
+		{
+			return m_items.begin() + m_size;
+		}
+
+		const_iterator begin() const
+		{
+			return m_items.begin();
+		}
+
+		const_iterator end() const
+		{
+			return m_items.begin() + m_size;
+		}
+
+		size_t size() const
+		{
+			return m_size;
+		}
+
+		bool empty() const
+		{
+			return 0 == m_size;
+		}
+
+		/// @brief forget entries, slots are kept for reuse
+		void clear()
+		{
+			m_size = 0;
+		}
+	};
+
+} // namespace zubr
+
+
+#endif
@@ -34,9 +34,12 @@ SOFTWARE.
 #include <functional>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
+#include "RecyclingMap.hpp"
+
 
 namespace zubr {
 
@@ -80,6 +83,11 @@ namespace zubr {
 			int defaultValue = -1 )
 			= 0;
 
+		virtual Serializer & Deserialize( bool & out,
+			const std::string & memberName = "",
+			bool defaultValue = false )
+			= 0;
+
 		virtual Serializer & Deserialize( int64_t & out,
 			const std::string & memberName = "",
 			int64_t defaultValue = INT64_C( -1 ) )
@@ -90,6 +98,13 @@ namespace zubr {
 			const std::string & defaultValue = "" )
 			= 0;
 
+		/// @brief deserialize string without copying, the view is valid
+		/// while the message is retained and until a reused serializer parses
+		/// the next one
+		virtual Serializer & Deserialize( std::string_view & out,
+			const std::string & memberName = "" )
+			= 0;
+
 		virtual Serializer & Deserialize(
 			Serializable & v, const std::string & memberName = "" )
 			= 0;
@@ -130,13 +145,80 @@ namespace zubr {
 			return *this;
 		}
 
+		/// @brief deserialize only the members whose key passes filter
+		/// @tparam TFilter bool( int key )
+		template <typename TItem, typename TFilter>
+		Serializer & Deserialize(
+			std::unordered_map<int, TItem> & v, TFilter & filter )
+		{
+
+			Deserialize( [this, &v, &filter](
+							 Serializer & s, const std::string & memberName ) {
+				auto key = std::stoi( memberName );
+
+				if ( filter( key ) ) {
+					TItem item;
+					item.Deserialize( s );
+					v[key] = item;
+				}
+			} );
+
+			return *this;
+		}
+
+		/// @brief deserialize members into recycled slots
+		template <typename TItem>
+		Serializer & Deserialize( RecyclingMap<int, TItem> & v )
+		{
+
+			Deserialize( [&v]( Serializer & s, const std::string & memberName ) {
+				v.Acquire( std::stoi( memberName ) ).Deserialize( s );
+			} );
+
+			return *this;
+		}
+
+		/// @brief deserialize only the members whose key passes filter into
+		/// recycled slots
+		/// @tparam TFilter bool( int key )
+		template <typename TItem, typename TFilter>
+		Serializer & Deserialize(
+			RecyclingMap<int, TItem> & v, TFilter & filter )
+		{
+
+			Deserialize( [&v, &filter](
+							 Serializer & s, const std::string & memberName ) {
+				auto key = std::stoi( memberName );
+
+				if ( filter( key ) ) {
+					v.Acquire( key ).Deserialize( s );
+				}
+			} );
+
+			return *this;
+		}
+
+		/// @brief serializer of the same value retaining the whole message,
+		/// a reused serializer invalidates it on the next FromString
+		virtual std::shared_ptr<Serializer> Clone() = 0;
+
+		/// @brief drop the written document, memory is kept; a root
+		/// serializer is then reused to write the next one
+		virtual void Clear() = 0;
+
 		virtual void ToString( std::string & out ) = 0;
 		virtual void FromString( const std::string & s ) = 0;
 	};
 
 	class SerializerFactory {
 	public:
-		virtual std::shared_ptr<Serializer> Create() const = 0;
+		/// @brief create serializer
+		/// @param arenaSize bytes preallocated for a parsed message, 0 - grow
+		/// on demand; a serializer with an arena is meant to be reused for
+		/// every incoming message of a connection
+		/// @return
+		virtual std::shared_ptr<Serializer> Create( size_t arenaSize = 0 ) const
+			= 0;
 	};
 
 } // namespace zubr
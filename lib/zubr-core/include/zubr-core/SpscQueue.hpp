@@ -0,0 +1,126 @@
+/*
+MIT License
+
+Copyright (c) 2020 Denis Rozhkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// SpscQueue.hpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#ifndef __ZUBR_SPSC_QUEUE__H
+#define __ZUBR_SPSC_QUEUE__H
+
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+
+namespace zubr {
+
+	/// @brief bounded lock-free single producer single consumer queue
+	/// @tparam T item type
+	template <typename T> class SpscQueue {
+	protected:
+		std::vector<T> m_items;
+		size_t m_mask;
+
+		// consumer position
+		alignas( 64 ) std::atomic<size_t> m_head;
+		// producer position
+		alignas( 64 ) std::atomic<size_t> m_tail;
+
+	protected:
+		static size_t roundUp( size_t capacity )
+		{
+			size_t result = 2;
+
+			while ( result < capacity ) {
+				result <<= 1;
+			}
+
+			return result;
+		}
+
+	public:
+		/// @brief bounded lock-free single producer single consumer queue
+		/// @param capacity rounded up to a power of two
+		explicit SpscQueue( size_t capacity )
+			: m_items( roundUp( capacity ) )
+			, m_mask( m_items.size() - 1 )
+			, m_head( 0 )
+			, m_tail( 0 )
+		{
+		}
+
+		SpscQueue( const SpscQueue & ) = delete;
+		SpscQueue & operator=( const SpscQueue & ) = delete;
+
+		/// @brief enqueue item (producer side)
+		/// @param item
+		/// @return false if the queue is full
+		template <typename TItem> bool Push( TItem && item )
+		{
+			auto tail = m_tail.load( std::memory_order_relaxed );
+
+			if ( tail - m_head.load( std::memory_order_acquire )
+				 == m_items.size() ) {
+
+				return false;
+			}
+
+			m_items[tail & m_mask] = std::forward<TItem>( item );
+			m_tail.store( tail + 1, std::memory_order_release );
+
+			return true;
+		}
+
+		/// @brief dequeue item (consumer side)
+		/// @param out
+		/// @return false if the queue is empty
+		bool Pop( T & out )
+		{
+			auto head = m_head.load( std::memory_order_relaxed );
+
+			if ( head == m_tail.load( std::memory_order_acquire ) ) {
+				return false;
+			}
+
+			out = std::move( m_items[head & m_mask] );
+			m_head.store( head + 1, std::memory_order_release );
+
+			return true;
+		}
+
+		bool Empty() const
+		{
+			return ( m_head.load( std::memory_order_acquire )
+					 == m_tail.load( std::memory_order_acquire ) );
+		}
+	};
+
+} // namespace zubr
+
+
+#endif
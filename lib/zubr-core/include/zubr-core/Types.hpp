@@ -34,7 +34,9 @@ SOFTWARE.
 #include <chrono>
 #include <cmath>
 #include <iostream>
+#include <string_view>
 
+#include "EnumCodec.hpp"
 #include "Serializer.hpp"
 
 
@@ -73,6 +75,16 @@ namespace zubr {
 		void Serialize( Serializer & o ) override;
 		void Deserialize( Serializer & o ) override;
 
+		int64_t Significand() const
+		{
+			return m_significand;
+		}
+
+		int Exponent() const
+		{
+			return m_exponent;
+		}
+
 		int64_t Integer() const
 		{
 			return ( m_exponent < 0 ? m_significand / m_factor
@@ -119,6 +131,13 @@ namespace zubr {
 			return *this;
 		}
 
+		Number & Mul( int64_t m )
+		{
+			m_significand *= m;
+
+			return *this;
+		}
+
 		Number & Div( double d )
 		{
 			m_significand /= d;
@@ -178,6 +197,11 @@ namespace zubr {
 		{
 		}
 
+		Time()
+			: Time( 0 )
+		{
+		}
+
 		static Time Now()
 		{
 			return Time( std::chrono::duration_cast<std::chrono::seconds>(
@@ -195,6 +219,14 @@ namespace zubr {
 			return m_nanoseconds;
 		}
 
+		/// @brief nanoseconds since the epoch
+		/// @return
+		int64_t SinceEpochNs() const
+		{
+			return static_cast<int64_t>(
+				m_seconds * UINT64_C( 1000000000 ) + m_nanoseconds );
+		}
+
 		void Serialize( Serializer & o ) override;
 		void Deserialize( Serializer & o ) override;
 	};
@@ -211,134 +243,70 @@ namespace zubr {
 	};
 
 	class OrderEnumHelper {
+	protected:
+		static constexpr EnumName<OrderDirection> DirectionNames[]
+			= { { "BUY", OrderDirection::Buy },
+				{ "SELL", OrderDirection::Sell } };
+
+		static constexpr EnumName<OrderType> TypeNames[]
+			= { { "LIMIT", OrderType::Limit },
+				{ "POST_ONLY", OrderType::PostOnly } };
+
+		static constexpr EnumName<OrderLifetime> LifetimeNames[]
+			= { { "GTC", OrderLifetime::Gtc },
+				{ "IOC", OrderLifetime::IoC },
+				{ "FOK", OrderLifetime::FoK } };
+
+		static constexpr EnumName<OrderStatus> StatusNames[]
+			= { { "NEW", OrderStatus::New },
+				{ "FILLED", OrderStatus::Filled },
+				{ "CANCELLED", OrderStatus::Cancelled },
+				{ "PARTIALLY_FILLED", OrderStatus::PartiallyFilled } };
+
+		static constexpr EnumCodec DirectionCodec{ DirectionNames };
+		static constexpr EnumCodec TypeCodec{ TypeNames };
+		static constexpr EnumCodec LifetimeCodec{ LifetimeNames };
+		static constexpr EnumCodec StatusCodec{ StatusNames };
+
 	public:
 		static const char * ToString( OrderDirection direction )
 		{
-			switch ( direction ) {
-				case OrderDirection::Buy:
-					return "BUY";
-
-				case OrderDirection::Sell:
-					return "SELL";
-
-				default:
-					return "N/A";
-			}
+			return DirectionCodec.ToString( direction );
 		}
 
 		static const char * ToString( OrderType type )
 		{
-			switch ( type ) {
-				case OrderType::Limit:
-					return "LIMIT";
-
-				case OrderType::PostOnly:
-					return "POST_ONLY";
-
-				default:
-					return "N/A";
-			}
+			return TypeCodec.ToString( type );
 		}
 
 		static const char * ToString( OrderLifetime lifetime )
 		{
-			switch ( lifetime ) {
-				case OrderLifetime::FoK:
-					return "FOK";
-
-				case OrderLifetime::Gtc:
-					return "GTC";
-
-				case OrderLifetime::IoC:
-					return "IOC";
-
-				default:
-					return "N/A";
-			}
+			return LifetimeCodec.ToString( lifetime );
 		}
 
 		static const char * ToString( OrderStatus status )
 		{
-			switch ( status ) {
-				case OrderStatus::Cancelled:
-					return "CANCELLED";
-
-				case OrderStatus::Filled:
-					return "FILLED";
-
-				case OrderStatus::New:
-					return "NEW";
-
-				case OrderStatus::PartiallyFilled:
-					return "PARTIALLY_FILLED";
-
-				default:
-					return "N/A";
-			}
+			return StatusCodec.ToString( status );
 		}
 
-		static OrderType FromOrderTypeName( const std::string & name )
+		static OrderType FromOrderTypeName( std::string_view name )
 		{
-			if ( ToString( OrderType::Limit ) == name ) {
-				return OrderType::Limit;
-			}
-
-			if ( ToString( OrderType::PostOnly ) == name ) {
-				return OrderType::PostOnly;
-			}
-
-			return OrderType::_undef;
+			return TypeCodec.FromString( name );
 		}
 
-		static OrderLifetime FromOrderLifetimeName( const std::string & name )
+		static OrderLifetime FromOrderLifetimeName( std::string_view name )
 		{
-			if ( ToString( OrderLifetime::FoK ) == name ) {
-				return OrderLifetime::FoK;
-			}
-
-			if ( ToString( OrderLifetime::Gtc ) == name ) {
-				return OrderLifetime::Gtc;
-			}
-
-			if ( ToString( OrderLifetime::IoC ) == name ) {
-				return OrderLifetime::IoC;
-			}
-
-			return OrderLifetime::_undef;
+			return LifetimeCodec.FromString( name );
 		}
 
-		static OrderDirection FromOrderDirectionName( const std::string & name )
+		static OrderDirection FromOrderDirectionName( std::string_view name )
 		{
-			if ( ToString( OrderDirection::Buy ) == name ) {
-				return OrderDirection::Buy;
-			}
-
-			if ( ToString( OrderDirection::Sell ) == name ) {
-				return OrderDirection::Sell;
-			}
-
-			return OrderDirection::_undef;
+			return DirectionCodec.FromString( name );
 		}
 
-		static OrderStatus FromOrderStatusName( const std::string & name )
+		static OrderStatus FromOrderStatusName( std::string_view name )
 		{
-			if ( ToString( OrderStatus::Cancelled ) == name ) {
-				return OrderStatus::Cancelled;
-			}
-
-			if ( ToString( OrderStatus::Filled ) == name ) {
-				return OrderStatus::Filled;
-			}
-
-			if ( ToString( OrderStatus::New ) == name ) {
-				return OrderStatus::New;
-			}
-
-			if ( ToString( OrderStatus::PartiallyFilled ) == name ) {
-				return OrderStatus::PartiallyFilled;
-			}
-
-			return OrderStatus::_undef;
+			return StatusCodec.FromString( name );
 		}
 	};
 
@@ -377,6 +345,12 @@ namespace zubr {
 			return m_instrumentId;
 		}
 
+		/// @brief the entry is the complete book, not a change of levels
+		bool IsSnapshot() const
+		{
+			return m_isSnapshot;
+		}
+
 		const std::vector<OrderBookEntryItem> & Bids() const
 		{
 			return m_bids;
@@ -388,65 +362,271 @@ namespace zubr {
 		}
 	};
 
+	/// @brief field decoded from the retained message on first access
+	/// @tparam T field type
+	template <typename T> class LazyField {
+	protected:
+		mutable T m_value;
+		mutable bool m_isDecoded;
+
+	public:
+		LazyField()
+			: m_value()
+			, m_isDecoded( false )
+		{
+		}
+
+		void Reset()
+		{
+			m_isDecoded = false;
+		}
+
+		/// @brief decode member of source on first access
+		const T & Get( const std::shared_ptr<Serializer> & source,
+			const char * memberName ) const
+		{
+
+			if ( !m_isDecoded && source ) {
+				source->Deserialize( m_value, memberName );
+				m_isDecoded = true;
+			}
+
+			return m_value;
+		}
+
+		/// @brief decode with decoder on first access
+		/// @tparam TDecoder void( T & )
+		template <typename TDecoder>
+		const T & Get( const TDecoder & decoder ) const
+		{
+			if ( !m_isDecoded ) {
+				decoder( m_value );
+				m_isDecoded = true;
+			}
+
+			return m_value;
+		}
+	};
+
+	/// @brief order view over the retained message, fields are decoded
+	/// on first access
 	class OrderEntry : public Serializable {
 	protected:
-		int m_instrumentId;
-		OrderType m_type;
-		OrderLifetime m_lifetime;
-		OrderDirection m_direction;
-		OrderStatus m_status;
-		int m_quantityInitial;
-		int m_quantityRemaining;
-		Number m_price;
-		t_order_id m_id;
+		std::shared_ptr<Serializer> m_source;
+
+		LazyField<int> m_instrumentId;
+		LazyField<OrderType> m_type;
+		LazyField<OrderLifetime> m_lifetime;
+		LazyField<OrderDirection> m_direction;
+		LazyField<OrderStatus> m_status;
+		LazyField<int> m_quantityInitial;
+		LazyField<int> m_quantityRemaining;
+		LazyField<Number> m_price;
+		LazyField<t_order_id> m_id;
+
+	protected:
+		std::string_view name( const char * memberName ) const
+		{
+			std::string_view result;
+
+			if ( m_source ) {
+				m_source->Deserialize( result, memberName );
+			}
+
+			return result;
+		}
 
 	public:
 		void Deserialize( Serializer & s ) override;
 
 		int InstrumentId() const
 		{
-			return m_instrumentId;
+			return m_instrumentId.Get( m_source, "instrument" );
 		}
-		
+
 		t_order_id Id() const
 		{
-			return m_id;
+			return m_id.Get( m_source, "id" );
 		}
 
 		OrderType Type() const
 		{
-			return m_type;
+			return m_type.Get( [this]( OrderType & out ) {
+				out = OrderEnumHelper::FromOrderTypeName( name( "type" ) );
+			} );
 		}
 
 		OrderLifetime Lifetime() const
 		{
-			return m_lifetime;
+			return m_lifetime.Get( [this]( OrderLifetime & out ) {
+				out = OrderEnumHelper::FromOrderLifetimeName(
+					name( "timeInForce" ) );
+			} );
 		}
 
 		OrderDirection Direction() const
 		{
-			return m_direction;
+			return m_direction.Get( [this]( OrderDirection & out ) {
+				out = OrderEnumHelper::FromOrderDirectionName( name( "side" ) );
+			} );
 		}
 
 		OrderStatus Status() const
 		{
-			return m_status;
+			return m_status.Get( [this]( OrderStatus & out ) {
+				out = OrderEnumHelper::FromOrderStatusName( name( "status" ) );
+			} );
 		}
 
 		int QuantityInitial() const
 		{
-			return m_quantityInitial;
+			return m_quantityInitial.Get( m_source, "initialSize" );
 		}
 
 		int QuantityRemaining() const
 		{
-			return m_quantityRemaining;
+			return m_quantityRemaining.Get( m_source, "remainingSize" );
+		}
+
+		const Number & Price() const
+		{
+			return m_price.Get( m_source, "price" );
+		}
+	};
+
+	/// @brief own trade view over the retained message, fields are decoded
+	/// on first access
+	class OrderFill : public Serializable {
+	protected:
+		std::shared_ptr<Serializer> m_source;
+
+		LazyField<t_order_id> m_id;
+		LazyField<t_order_id> m_orderId;
+		LazyField<int> m_instrumentId;
+		LazyField<OrderDirection> m_direction;
+		LazyField<Number> m_price;
+		LazyField<int> m_quantity;
+		LazyField<Number> m_exchangeFee;
+		LazyField<Number> m_brokerFee;
+		LazyField<Time> m_time;
+
+	public:
+		void Deserialize( Serializer & s ) override;
+
+		t_order_id Id() const
+		{
+			return m_id.Get( m_source, "id" );
+		}
+
+		t_order_id OrderId() const
+		{
+			return m_orderId.Get( m_source, "orderId" );
+		}
+
+		int InstrumentId() const
+		{
+			return m_instrumentId.Get( m_source, "instrument" );
+		}
+
+		OrderDirection Direction() const
+		{
+			return m_direction.Get( [this]( OrderDirection & out ) {
+				std::string_view name;
+
+				if ( m_source ) {
+					m_source->Deserialize( name, "side" );
+				}
+
+				out = OrderEnumHelper::FromOrderDirectionName( name );
+			} );
+		}
+
+		const Number & Price() const
+		{
+			return m_price.Get( m_source, "price" );
+		}
+
+		int Quantity() const
+		{
+			return m_quantity.Get( m_source, "size" );
+		}
+
+		const Number & ExchangeFee() const
+		{
+			return m_exchangeFee.Get( m_source, "exchangeFee" );
+		}
+
+		const Number & BrokerFee() const
+		{
+			return m_brokerFee.Get( m_source, "brokerFee" );
+		}
+
+		/// @brief fees charged for the fill, absent fees count as 0
+		/// @return
+		double Fee() const
+		{
+			return ( ExchangeFee().HasValue() ? ExchangeFee().Value() : 0 )
+				+ ( BrokerFee().HasValue() ? BrokerFee().Value() : 0 );
+		}
+
+		/// @brief exchange time of the trade
+		const Time & TradeTime() const
+		{
+			return m_time.Get( m_source, "time" );
+		}
+	};
+
+	/// @brief public trade
+	class Trade : public Serializable {
+	protected:
+		t_order_id m_id;
+		int m_instrumentId;
+		Number m_price;
+		int m_quantity;
+		OrderDirection m_direction;
+		Time m_time;
+
+	public:
+		Trade()
+			: m_id( 0 )
+			, m_instrumentId( 0 )
+			, m_quantity( 0 )
+			, m_direction( OrderDirection::_undef )
+		{
+		}
+
+		void Deserialize( Serializer & s ) override;
+
+		t_order_id Id() const
+		{
+			return m_id;
+		}
+
+		int InstrumentId() const
+		{
+			return m_instrumentId;
 		}
 
 		const Number & Price() const
 		{
 			return m_price;
 		}
+
+		int Quantity() const
+		{
+			return m_quantity;
+		}
+
+		/// @brief side of the aggressor, _undef if not reported
+		OrderDirection Direction() const
+		{
+			return m_direction;
+		}
+
+		const Time & TradeTime() const
+		{
+			return m_time;
+		}
 	};
 
 	class Instrument : public Serializable {
@@ -468,52 +648,84 @@ namespace zubr {
 		}
 	};
 
+	/// @brief position view over the retained message, fields are decoded
+	/// on first access
 	class Position : public Serializable {
 	protected:
-		int m_instrumentId;
-		int m_size;
-
-		Number m_unrealizedPnl;
-		Number m_realizedPnl;
-		Number m_margin;
-		Number m_maxRemovableMargin;
-		Number m_entryPrice;
-		Number m_entryNotionalValue;
-		Number m_currentNotionalValue;
-		Number m_partialLiquidationPrice;
-		Number m_fullLiquidationPrice;
+		std::shared_ptr<Serializer> m_source;
+
+		LazyField<int> m_instrumentId;
+		LazyField<int> m_size;
+
+		LazyField<Number> m_unrealizedPnl;
+		LazyField<Number> m_realizedPnl;
+		LazyField<Number> m_margin;
+		LazyField<Number> m_maxRemovableMargin;
+		LazyField<Number> m_entryPrice;
+		LazyField<Number> m_entryNotionalValue;
+		LazyField<Number> m_currentNotionalValue;
+		LazyField<Number> m_partialLiquidationPrice;
+		LazyField<Number> m_fullLiquidationPrice;
 
 	public:
 		void Deserialize( Serializer & s ) override;
 
 		int InstrumentId() const
 		{
-			return m_instrumentId;
+			return m_instrumentId.Get( m_source, "instrumentId" );
 		}
 
 		int Size() const
 		{
-			return m_size;
+			return m_size.Get( m_source, "size" );
 		}
 
 		const Number & UnrealizedPnl() const
 		{
-			return m_unrealizedPnl;
+			return m_unrealizedPnl.Get( m_source, "unrealizedPnl" );
 		}
 
 		const Number & RealizedPnl() const
 		{
-			return m_realizedPnl;
+			return m_realizedPnl.Get( m_source, "realizedPnl" );
 		}
 
 		const Number & Margin() const
 		{
-			return m_margin;
+			return m_margin.Get( m_source, "margin" );
 		}
 
 		const Number & MaxRemovableMargin() const
 		{
-			return m_maxRemovableMargin;
+			return m_maxRemovableMargin.Get( m_source, "maxRemovableMargin" );
+		}
+
+		const Number & EntryPrice() const
+		{
+			return m_entryPrice.Get( m_source, "entryPrice" );
+		}
+
+		const Number & EntryNotionalValue() const
+		{
+			return m_entryNotionalValue.Get( m_source, "entryNotionalValue" );
+		}
+
+		const Number & CurrentNotionalValue() const
+		{
+			return m_currentNotionalValue.Get(
+				m_source, "currentNotionalValue" );
+		}
+
+		const Number & PartialLiquidationPrice() const
+		{
+			return m_partialLiquidationPrice.Get(
+				m_source, "partialLiquidationPrice" );
+		}
+
+		const Number & FullLiquidationPrice() const
+		{
+			return m_fullLiquidationPrice.Get(
+				m_source, "fullLiquidationPrice" );
 		}
 	};
 
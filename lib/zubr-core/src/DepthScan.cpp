@@ -0,0 +1,384 @@
+/*
+MIT License
+
+Copyright (c) 2020 Denis Rozhkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// DepthScan.cpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#if defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#define ZUBR_DEPTH_SCAN_X86
+#include <immintrin.h>
+#endif
+
+#include <cstring>
+#include <vector>
+
+#include "../include/zubr-core/DepthScan.hpp"
+
+
+using namespace zubr;
+
+
+namespace {
+
+	struct kernels {
+		const char * isa;
+		void ( *prefixSum )( const int64_t *, int64_t *, size_t );
+		size_t ( *findCumulative )(
+			const int64_t *, size_t, int64_t, int64_t & );
+		void ( *weightedSum )( const int64_t *, size_t, int64_t &, int64_t & );
+	};
+
+
+	// tails continue from the running sums of the vectorized part
+
+	void prefixSumTail(
+		const int64_t * in, int64_t * out, size_t n, int64_t sum )
+	{
+
+		for ( size_t i = 0; i < n; ++i ) {
+			sum += in[i];
+			out[i] = sum;
+		}
+	}
+
+	size_t findCumulativeTail(
+		const int64_t * q, size_t n, int64_t threshold, int64_t & sum, size_t i )
+	{
+
+		for ( ; i < n; ++i ) {
+			sum += q[i];
+
+			if ( sum >= threshold ) {
+				return i;
+			}
+		}
+
+		return n;
+	}
+
+	void weightedSumTail( const int64_t * q,
+		size_t n,
+		int64_t & sum,
+		int64_t & weightedSum,
+		size_t i )
+	{
+
+		for ( ; i < n; ++i ) {
+			sum += q[i];
+			weightedSum += q[i] * static_cast<int64_t>( i );
+		}
+	}
+
+
+	void prefixSumScalar( const int64_t * in, int64_t * out, size_t n )
+	{
+		prefixSumTail( in, out, n, 0 );
+	}
+
+	size_t findCumulativeScalar(
+		const int64_t * q, size_t n, int64_t threshold, int64_t & sum )
+	{
+
+		sum = 0;
+
+		return findCumulativeTail( q, n, threshold, sum, 0 );
+	}
+
+	void weightedSumScalar(
+		const int64_t * q, size_t n, int64_t & sum, int64_t & weightedSum )
+	{
+
+		sum = 0;
+		weightedSum = 0;
+		weightedSumTail( q, n, sum, weightedSum, 0 );
+	}
+
+
+#ifdef ZUBR_DEPTH_SCAN_X86
+
+	// SSE2 is part of x86-64, two 64 bit lanes
+
+	inline __m128i scanSse2( __m128i x )
+	{
+		return _mm_add_epi64( x, _mm_slli_si128( x, 8 ) );
+	}
+
+	inline int64_t lastSse2( __m128i x )
+	{
+		int64_t v[2];
+		_mm_storeu_si128( reinterpret_cast<__m128i *>( v ), x );
+
+		return v[1];
+	}
+
+	void prefixSumSse2( const int64_t * in, int64_t * out, size_t n )
+	{
+		__m128i carry = _mm_setzero_si128();
+		size_t i = 0;
+
+		for ( ; i + 2 <= n; i += 2 ) {
+			auto x = _mm_loadu_si128( reinterpret_cast<const __m128i *>( in + i ) );
+			x = _mm_add_epi64( scanSse2( x ), carry );
+			_mm_storeu_si128( reinterpret_cast<__m128i *>( out + i ), x );
+			carry = _mm_shuffle_epi32( x, _MM_SHUFFLE( 3, 2, 3, 2 ) );
+		}
+
+		prefixSumTail( in + i, out + i, n - i, i > 0 ? out[i - 1] : 0 );
+	}
+
+	size_t findCumulativeSse2(
+		const int64_t * q, size_t n, int64_t threshold, int64_t & sum )
+	{
+
+		sum = 0;
+		size_t i = 0;
+
+		// whole blocks below the threshold, the block reaching it is
+		// finished by the scalar loop
+		for ( ; i + 2 <= n; i += 2 ) {
+			auto x = _mm_loadu_si128( reinterpret_cast<const __m128i *>( q + i ) );
+			auto blockSum = lastSse2( scanSse2( x ) );
+
+			if ( sum + blockSum >= threshold ) {
+				break;
+			}
+
+			sum += blockSum;
+		}
+
+		return findCumulativeTail( q, n, threshold, sum, i );
+	}
+
+	void weightedSumSse2(
+		const int64_t * q, size_t n, int64_t & sum, int64_t & weightedSum )
+	{
+
+		auto sums = _mm_setzero_si128();
+		auto weightedSums = _mm_setzero_si128();
+		auto index = _mm_set_epi64x( 1, 0 );
+		const auto step = _mm_set1_epi64x( 2 );
+		size_t i = 0;
+
+		for ( ; i + 2 <= n; i += 2 ) {
+			auto x = _mm_loadu_si128( reinterpret_cast<const __m128i *>( q + i ) );
+			sums = _mm_add_epi64( sums, x );
+			// low 32 bits of both
+			weightedSums
+				= _mm_add_epi64( weightedSums, _mm_mul_epu32( x, index ) );
+			index = _mm_add_epi64( index, step );
+		}
+
+		int64_t v[2];
+		_mm_storeu_si128( reinterpret_cast<__m128i *>( v ), sums );
+		sum = v[0] + v[1];
+		_mm_storeu_si128( reinterpret_cast<__m128i *>( v ), weightedSums );
+		weightedSum = v[0] + v[1];
+
+		weightedSumTail( q, n, sum, weightedSum, i );
+	}
+
+
+	// AVX2, four 64 bit lanes
+
+	__attribute__( ( target( "avx2" ) ) ) inline __m256i scanAvx2( __m256i x )
+	{
+		const auto zero = _mm256_setzero_si256();
+
+		// [0, x0, x1, x2]
+		auto t = _mm256_permute4x64_epi64( x, _MM_SHUFFLE( 2, 1, 0, 0 ) );
+		x = _mm256_add_epi64( x, _mm256_blend_epi32( t, zero, 0x03 ) );
+
+		// [0, 0, x0, x1]
+		t = _mm256_permute4x64_epi64( x, _MM_SHUFFLE( 1, 0, 0, 0 ) );
+
+		return _mm256_add_epi64( x, _mm256_blend_epi32( t, zero, 0x0f ) );
+	}
+
+	__attribute__( ( target( "avx2" ) ) ) void prefixSumAvx2(
+		const int64_t * in, int64_t * out, size_t n )
+	{
+
+		auto carry = _mm256_setzero_si256();
+		size_t i = 0;
+
+		for ( ; i + 4 <= n; i += 4 ) {
+			auto x = _mm256_loadu_si256(
+				reinterpret_cast<const __m256i *>( in + i ) );
+
+			x = _mm256_add_epi64( scanAvx2( x ), carry );
+			_mm256_storeu_si256( reinterpret_cast<__m256i *>( out + i ), x );
+			carry = _mm256_permute4x64_epi64( x, _MM_SHUFFLE( 3, 3, 3, 3 ) );
+		}
+
+		prefixSumTail( in + i, out + i, n - i, i > 0 ? out[i - 1] : 0 );
+	}
+
+	__attribute__( ( target( "avx2" ) ) ) size_t findCumulativeAvx2(
+		const int64_t * q, size_t n, int64_t threshold, int64_t & sum )
+	{
+
+		sum = 0;
+
+		auto carry = _mm256_setzero_si256();
+		const auto limit = _mm256_set1_epi64x( threshold - 1 );
+		size_t i = 0;
+
+		for ( ; i + 4 <= n; i += 4 ) {
+			auto x = _mm256_loadu_si256(
+				reinterpret_cast<const __m256i *>( q + i ) );
+
+			x = _mm256_add_epi64( scanAvx2( x ), carry );
+
+			// running sums reaching the threshold
+			auto mask = _mm256_movemask_pd(
+				_mm256_castsi256_pd( _mm256_cmpgt_epi64( x, limit ) ) );
+
+			if ( mask != 0 ) {
+				auto lane = __builtin_ctz( mask );
+				int64_t v[4];
+				_mm256_storeu_si256( reinterpret_cast<__m256i *>( v ), x );
+				sum = v[lane];
+
+				return i + lane;
+			}
+
+			carry = _mm256_permute4x64_epi64( x, _MM_SHUFFLE( 3, 3, 3, 3 ) );
+		}
+
+		int64_t v[4];
+		_mm256_storeu_si256( reinterpret_cast<__m256i *>( v ), carry );
+		sum = v[0];
+
+		return findCumulativeTail( q, n, threshold, sum, i );
+	}
+
+	__attribute__( ( target( "avx2" ) ) ) void weightedSumAvx2(
+		const int64_t * q, size_t n, int64_t & sum, int64_t & weightedSum )
+	{
+
+		auto sums = _mm256_setzero_si256();
+		auto weightedSums = _mm256_setzero_si256();
+		auto index = _mm256_set_epi64x( 3, 2, 1, 0 );
+		const auto step = _mm256_set1_epi64x( 4 );
+		size_t i = 0;
+
+		for ( ; i + 4 <= n; i += 4 ) {
+			auto x = _mm256_loadu_si256(
+				reinterpret_cast<const __m256i *>( q + i ) );
+
+			sums = _mm256_add_epi64( sums, x );
+			weightedSums = _mm256_add_epi64(
+				weightedSums, _mm256_mul_epu32( x, index ) );
+			index = _mm256_add_epi64( index, step );
+		}
+
+		int64_t v[4];
+		_mm256_storeu_si256( reinterpret_cast<__m256i *>( v ), sums );
+		sum = v[0] + v[1] + v[2] + v[3];
+		_mm256_storeu_si256( reinterpret_cast<__m256i *>( v ), weightedSums );
+		weightedSum = v[0] + v[1] + v[2] + v[3];
+
+		weightedSumTail( q, n, sum, weightedSum, i );
+	}
+
+#endif
+
+
+	/// @brief implementations supported by the CPU, preferred first
+	std::vector<kernels> supported()
+	{
+		std::vector<kernels> result;
+
+#ifdef ZUBR_DEPTH_SCAN_X86
+		__builtin_cpu_init();
+
+		if ( __builtin_cpu_supports( "avx2" ) ) {
+			result.push_back( kernels{ "avx2",
+				prefixSumAvx2,
+				findCumulativeAvx2,
+				weightedSumAvx2 } );
+		}
+
+		if ( __builtin_cpu_supports( "sse2" ) ) {
+			result.push_back( kernels{
+				"sse2", prefixSumSse2, findCumulativeSse2, weightedSumSse2 } );
+		}
+#endif
+
+		result.push_back( kernels{ "scalar",
+			prefixSumScalar,
+			findCumulativeScalar,
+			weightedSumScalar } );
+
+		return result;
+	}
+
+	kernels & selected()
+	{
+		static kernels k = supported().front();
+
+		return k;
+	}
+
+} // namespace
+
+
+void DepthScan::PrefixSum( const int64_t * in, int64_t * out, size_t n )
+{
+	selected().prefixSum( in, out, n );
+}
+
+size_t DepthScan::FindCumulative(
+	const int64_t * q, size_t n, int64_t threshold, int64_t & sum )
+{
+
+	return selected().findCumulative( q, n, threshold, sum );
+}
+
+void DepthScan::WeightedSum(
+	const int64_t * q, size_t n, int64_t & sum, int64_t & weightedSum )
+{
+
+	selected().weightedSum( q, n, sum, weightedSum );
+}
+
+const char * DepthScan::Isa()
+{
+	return selected().isa;
+}
+
+bool DepthScan::Select( const char * isa )
+{
+	for ( auto & k : supported() ) {
+		if ( 0 == std::strcmp( k.isa, isa ) ) {
+			selected() = k;
+
+			return true;
+		}
+	}
+
+	return false;
+}
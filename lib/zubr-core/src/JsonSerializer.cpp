@@ -27,8 +27,7 @@ SOFTWARE.
 /// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
 ///
 
-#include "rapidjson/stringbuffer.h"
-#include "rapidjson/writer.h"
+#include <algorithm>
 
 #include "../include/zubr-core/JsonSerializer.hpp"
 
@@ -36,41 +35,108 @@ SOFTWARE.
 using namespace zubr;
 
 
+JsonFrame::JsonFrame( size_t arenaSize )
+	: m_arenaSize( std::max( arenaSize, MinArenaSize ) )
+	, m_valueArenaSize( ( m_arenaSize / 4 * 3 ) & ~size_t( 7 ) )
+	, m_arena( new char[m_arenaSize] )
+	, m_valueAllocator( m_arena.get(), m_valueArenaSize )
+	, m_stackAllocator( m_arena.get() + m_valueArenaSize,
+		  m_arenaSize - m_valueArenaSize )
+	, m_document( &m_valueAllocator, StackCapacity, &m_stackAllocator )
+	, m_childrenCount( 0 )
+	, m_writer( m_output )
+{
+}
+
+std::shared_ptr<Serializer> JsonFrame::Child( rapidjson::Value & value )
+{
+	auto index = m_childrenCount / ChildrenChunkSize;
+
+	// chunks never grow past their capacity, so children keep their
+	// addresses while more are added
+	if ( m_children.size() == index ) {
+		m_children.emplace_back();
+		m_children.back().reserve( ChildrenChunkSize );
+	}
+
+	auto & chunk = m_children[index];
+	chunk.emplace_back( this, &value );
+	++m_childrenCount;
+
+	return std::shared_ptr<Serializer>( shared_from_this(), &chunk.back() );
+}
+
+void JsonFrame::Reset()
+{
+	for ( auto & chunk : m_children ) {
+		if ( chunk.empty() ) {
+			break;
+		}
+
+		chunk.clear();
+	}
+
+	m_childrenCount = 0;
+
+	m_document.SetNull();
+	m_valueAllocator.Clear();
+	m_stackAllocator.Clear();
+}
+
+void JsonFrame::Write( std::string & out )
+{
+	m_output.Clear();
+	m_writer.Reset( m_output );
+	m_document.Accept( m_writer );
+	out.assign( m_output.GetString(), m_output.GetSize() );
+}
+
+
+JsonSerializer::JsonSerializer( size_t arenaSize )
+	: m_frameHolder( std::make_shared<JsonFrame>( arenaSize ) )
+	, m_frame( m_frameHolder.get() )
+	, m_value( &m_frame->Document().SetObject() )
+{
+}
+
+
 std::shared_ptr<Serializer> JsonSerializer::AddObject(
 	const std::string & memberName )
 {
 
+	auto & allocator = m_frame->Document().GetAllocator();
+
 	rapidjson::Value object( rapidjson::kObjectType );
-	m_value.AddMember( rapidjson::Value().SetString(
-						   memberName.c_str(), m_document->GetAllocator() ),
+	m_value->AddMember(
+		rapidjson::Value().SetString( memberName.c_str(), allocator ),
 		object,
-		m_document->GetAllocator() );
+		allocator );
 
-	return std::shared_ptr<Serializer>(
-		new JsonSerializer( m_document, m_value[memberName.c_str()] ) );
+	return m_frame->Child( ( *m_value )[memberName.c_str()] );
 }
 
 std::shared_ptr<Serializer> JsonSerializer::GetObject(
 	const std::string & memberName )
 {
-	if ( !m_value.HasMember( memberName.c_str() )
-		 || m_value[memberName.c_str()].IsNull() ) {
+	auto it = m_value->FindMember( memberName.c_str() );
 
+	if ( m_value->MemberEnd() == it || it->value.IsNull() ) {
 		return nullptr;
 	}
 
-	return std::shared_ptr<Serializer>(
-		new JsonSerializer( m_document, m_value[memberName.c_str()] ) );
+	return m_frame->Child( it->value );
 }
 
 Serializer & JsonSerializer::Serialize(
 	int64_t v, const std::string & memberName )
 {
 
-	m_value.AddMember( rapidjson::Value().SetString(
-						   memberName.c_str(), m_document->GetAllocator() ),
+	auto & allocator = m_frame->Document().GetAllocator();
+
+	m_value->AddMember(
+		rapidjson::Value().SetString( memberName.c_str(), allocator ),
 		v,
-		m_document->GetAllocator() );
+		allocator );
 
 	return *this;
 }
@@ -79,10 +145,12 @@ Serializer & JsonSerializer::Serialize(
 	const std::string & v, const std::string & memberName )
 {
 
-	m_value.AddMember( rapidjson::Value().SetString(
-						   memberName.c_str(), m_document->GetAllocator() ),
-		rapidjson::Value().SetString( v.c_str(), m_document->GetAllocator() ),
-		m_document->GetAllocator() );
+	auto & allocator = m_frame->Document().GetAllocator();
+
+	m_value->AddMember(
+		rapidjson::Value().SetString( memberName.c_str(), allocator ),
+		rapidjson::Value().SetString( v.c_str(), allocator ),
+		allocator );
 
 	return *this;
 }
@@ -107,17 +175,35 @@ Serializer & JsonSerializer::Deserialize(
 	return *this;
 }
 
+Serializer & JsonSerializer::Deserialize(
+	bool & out, const std::string & memberName, bool defaultValue )
+{
+
+	if ( memberName.empty() ) {
+		out = m_value->GetBool();
+	}
+	else {
+		auto it = m_value->FindMember( memberName.c_str() );
+
+		out = ( m_value->MemberEnd() != it && it->value.IsBool()
+					? it->value.GetBool()
+					: defaultValue );
+	}
+
+	return *this;
+}
+
 Serializer & JsonSerializer::Deserialize(
 	int64_t & out, const std::string & memberName, int64_t defaultValue )
 
 {
 
 	if ( memberName.empty() ) {
-		out = m_value.GetInt64();
+		out = m_value->GetInt64();
 	}
 	else {
-		out = ( m_value.HasMember( memberName.c_str() )
-					? m_value[memberName.c_str()].GetInt64()
+		out = ( m_value->HasMember( memberName.c_str() )
+					? ( *m_value )[memberName.c_str()].GetInt64()
 					: defaultValue );
 	}
 
@@ -130,17 +216,37 @@ Serializer & JsonSerializer::Deserialize( std::string & out,
 {
 
 	if ( memberName.empty() ) {
-		out.assign( m_value.GetString() );
+		out.assign( m_value->GetString() );
 	}
 	else {
-		out.assign( m_value.HasMember( memberName.c_str() )
-						? m_value[memberName.c_str()].GetString()
+		out.assign( m_value->HasMember( memberName.c_str() )
+						? ( *m_value )[memberName.c_str()].GetString()
 						: defaultValue );
 	}
 
 	return *this;
 }
 
+Serializer & JsonSerializer::Deserialize(
+	std::string_view & out, const std::string & memberName )
+{
+
+	if ( memberName.empty() ) {
+		out = std::string_view(
+			m_value->GetString(), m_value->GetStringLength() );
+	}
+	else {
+		auto it = m_value->FindMember( memberName.c_str() );
+
+		out = ( m_value->MemberEnd() != it && it->value.IsString()
+					? std::string_view(
+						it->value.GetString(), it->value.GetStringLength() )
+					: std::string_view() );
+	}
+
+	return *this;
+}
+
 Serializer & JsonSerializer::Deserialize(
 	Serializable & v, const std::string & memberName )
 {
@@ -161,18 +267,16 @@ Serializer & JsonSerializer::Deserialize(
 {
 
 	if ( !memberName.empty() ) {
-		auto array = m_value[memberName.c_str()].GetArray();
+		auto array = ( *m_value )[memberName.c_str()].GetArray();
 
 		for ( rapidjson::SizeType i = 0; i < array.Size(); ++i ) {
-			JsonSerializer serializer( m_document, array[i] );
+			JsonSerializer serializer( m_frame, &array[i] );
 			add( serializer, "" );
 		}
 	}
 	else {
-		for ( auto & member : m_value.GetObject() ) {
-			JsonSerializer serializer(
-				m_document, m_value[member.name.GetString()] );
-
+		for ( auto & member : m_value->GetObject() ) {
+			JsonSerializer serializer( m_frame, &member.value );
 			add( serializer, member.name.GetString() );
 		}
 	}
@@ -180,16 +284,24 @@ Serializer & JsonSerializer::Deserialize(
 	return *this;
 }
 
+std::shared_ptr<Serializer> JsonSerializer::Clone()
+{
+	return m_frame->Child( *m_value );
+}
+
+void JsonSerializer::Clear()
+{
+	m_frame->Reset();
+	m_value = &m_frame->Document().SetObject();
+}
+
 void JsonSerializer::ToString( std::string & out )
 {
-	rapidjson::StringBuffer buffer;
-	rapidjson::Writer<rapidjson::StringBuffer> writer( buffer );
-	m_document->Accept( writer );
-	out.assign( buffer.GetString() );
+	m_frame->Write( out );
 }
 
 void JsonSerializer::FromString( const std::string & s )
 {
-	m_document->Parse( s.c_str() );
-	m_value = m_document->GetObject();
+	m_frame->Reset();
+	m_value = &m_frame->Document().Parse( s.c_str() );
 }
@@ -50,6 +50,14 @@ void Number::Deserialize( Serializer & o )
 
 void Time::Deserialize( Serializer & o )
 {
+	int64_t seconds;
+	int64_t nanoseconds;
+
+	o.Deserialize( seconds, "seconds", 0 )
+		.Deserialize( nanoseconds, "nanos", 0 );
+
+	m_seconds = seconds;
+	m_nanoseconds = nanoseconds;
 }
 
 void Time::Serialize( Serializer & o )
@@ -66,7 +74,11 @@ void OrderBookEntryItem::Deserialize( Serializer & o )
 
 void OrderBookEntry::Deserialize( Serializer & o )
 {
+	m_bids.clear();
+	m_asks.clear();
+
 	o.Deserialize( m_instrumentId, "instrumentId" );
+	o.Deserialize( m_isSnapshot, "isSnapshot" );
 	o.Deserialize( m_bids, "bids" );
 	o.Deserialize( m_asks, "asks" );
 }
@@ -74,26 +86,32 @@ void OrderBookEntry::Deserialize( Serializer & o )
 
 void OrderEntry::Deserialize( Serializer & o )
 {
-	std::string stringValue;
+	*this = OrderEntry();
+	m_source = o.Clone();
+}
 
-	o.Deserialize( m_id, "id" );
-	o.Deserialize( m_instrumentId, "instrument" );
 
-	o.Deserialize( stringValue, "type" );
-	m_type = OrderEnumHelper::FromOrderTypeName( stringValue );
+void OrderFill::Deserialize( Serializer & o )
+{
+	*this = OrderFill();
+	m_source = o.Clone();
+}
 
-	o.Deserialize( stringValue, "timeInForce" );
-	m_lifetime = OrderEnumHelper::FromOrderLifetimeName( stringValue );
 
-	o.Deserialize( stringValue, "side" );
-	m_direction = OrderEnumHelper::FromOrderDirectionName( stringValue );
+void Trade::Deserialize( Serializer & o )
+{
+	*this = Trade();
+
+	std::string_view side;
 
-	o.Deserialize( stringValue, "status" );
-	m_status = OrderEnumHelper::FromOrderStatusName( stringValue );
+	o.Deserialize( m_id, "id" )
+		.Deserialize( m_instrumentId, "instrumentId" )
+		.Deserialize( m_price, "price" )
+		.Deserialize( m_quantity, "size" )
+		.Deserialize( side, "side" )
+		.Deserialize( m_time, "time" );
 
-	o.Deserialize( m_price, "price" );
-	o.Deserialize( m_quantityInitial, "initialSize" );
-	o.Deserialize( m_quantityRemaining, "remainingSize" );
+	m_direction = OrderEnumHelper::FromOrderDirectionName( side );
 }
 
 
@@ -106,15 +124,6 @@ void Instrument::Deserialize( Serializer & s )
 
 void Position::Deserialize( Serializer & s )
 {
-	s.Deserialize( m_instrumentId, "instrumentId" )
-		.Deserialize( m_size, "size" )
-		.Deserialize( m_unrealizedPnl, "unrealizedPnl" )
-		.Deserialize( m_realizedPnl, "realizedPnl" )
-		.Deserialize( m_margin, "margin" )
-		.Deserialize( m_maxRemovableMargin, "maxRemovableMargin" )
-		.Deserialize( m_entryPrice, "entryPrice" )
-		.Deserialize( m_entryNotionalValue, "entryNotionalValue" )
-		.Deserialize( m_currentNotionalValue, "currentNotionalValue" )
-		.Deserialize( m_partialLiquidationPrice, "partialLiquidationPrice" )
-		.Deserialize( m_fullLiquidationPrice, "fullLiquidationPrice" );
+	*this = Position();
+	m_source = s.Clone();
 }
@@ -27,6 +27,7 @@ SOFTWARE.
 /// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
 ///
 
+#include "zubr-core/DepthScan.hpp"
 #include "zubr-core/Logger.hpp"
 
 #include "bot.hpp"
@@ -35,278 +36,554 @@ SOFTWARE.
 using namespace zubr;
 
 
-Number bot::calculateOrderPrice( OrderDirection direction )
+quoter * bot::findQuoter( t_instrument_id instrumentId )
 {
-	zubr::Number price = m_bestBuyPrice;
-	price.Add( m_bestSellPrice ).Div( 2 );
+	auto it = m_quoters.find( instrumentId );
 
-	// BUY price = (current best purchase price + current best sale
-	// price) / 2 -
-	//	interest - shift * position;
-	// SELL price = (current best purchase price +
-	//	current best sale price) / 2 + interest - shift * position.
-	if ( OrderDirection::Buy == direction ) {
-		price.Sub( m_conf.Interest() );
+	return ( m_quoters.end() != it ? it->second.get() : nullptr );
+}
+
+void bot::PlaceOrder( const std::shared_ptr<PlaceOrderRequestWs> & req )
+{
+	if ( m_isHalted ) {
+		ZUBR_LOG_DEBUG( "[" << req->InstrumentId()
+							<< "] halted, placement dropped" );
+
+		return;
 	}
-	else {
-		price.Add( m_conf.Interest() );
+
+	if ( m_burstDepth > 0 ) {
+		m_burst.push_back( orderCommand::Place( req ) );
+		return;
 	}
 
-	price.Sub( m_conf.Shift() * m_positionSize ).ModRing( m_minPriceIncrement );
+	auto reqId = m_connector.Send( *req );
+	m_orderReqMap[reqId] = pendingOrder{ req, t_clock::now() };
+}
+
+void bot::CancelOrder( t_order_id orderId )
+{
+	// once halted every tracked order is cancelled once
+	if ( m_isHalted ) {
+		auto it = m_openOrders.find( orderId );
+
+		if ( m_openOrders.end() != it ) {
+			if ( it->second.isCancelSent ) {
+				return;
+			}
 
-	return price;
+			it->second.isCancelSent = true;
+		}
+	}
+
+	if ( m_burstDepth > 0 ) {
+		m_burst.push_back( orderCommand::Cancel( orderId ) );
+		return;
+	}
+
+	m_connector.Send<CancelOrderRequestWs>( orderId );
 }
 
-void bot::placeOrder( OrderDirection direction, int quantity, bool & isPlaced )
+void bot::ResubscribeOrderBook()
 {
-	zubr::Number price = calculateOrderPrice( direction );
+	auto now = t_clock::now();
 
-	ZUBR_LOG_INFO( "placing " << OrderEnumHelper::ToString( direction )
-							  << " order, price: " << price.Value() );
+	if ( now < m_orderBookResubscribeAt ) {
+		return;
+	}
 
-	auto req = std::make_shared<PlaceOrderRequestWs>( m_conf.InstrumentId(),
-		price,
-		direction,
-		m_conf.Quantity(),
-		zubr::OrderType::Limit,
-		zubr::OrderLifetime::Gtc );
+	m_orderBookResubscribeAt
+		= now + std::chrono::milliseconds( OrderBookResubscribeIntervalMs );
 
-	auto reqId = m_connector.Send( *req );
-	m_orderReqMap[reqId] = req;
+	m_connector.Send<zubr::UnsubscribeRequestWs>( zubr::Channel::OrderBook );
+	m_connector.Send<zubr::SubscribeRequestWs>( zubr::Channel::OrderBook );
+}
 
-	isPlaced = true;
+void bot::CancelAll( const char * reason )
+{
+	cancelAll( reason, false );
 }
 
-void bot::replaceOrderIfPriceChanged( OrderDirection direction )
+void bot::cancelAll( const char * reason, bool isStopping )
 {
-	std::unordered_map<t_order_id, std::shared_ptr<PlaceOrderRequestWs>> &
-		ordersMap
-		= OrderDirection::Buy == direction ? m_buyOrdersMap : m_sellOrdersMap;
+	m_isStopping = m_isStopping || isStopping;
 
-	if ( !ordersMap.empty() ) {
-		auto price = calculateOrderPrice( direction );
+	if ( m_isCancellingAll ) {
+		return;
+	}
 
-		for ( auto & itOrder : ordersMap ) {
-			// only less (<) operator is implemented
-			if ( itOrder.second->Price() < price
-				 || price < itOrder.second->Price() ) {
+	m_isHalted = true;
+	m_isCancellingAll = true;
+	m_cancelAllDeadline
+		= t_clock::now() + std::chrono::milliseconds( CancelAllTimeoutMs );
 
-				ZUBR_LOG_INFO( "replacing order... old price: "
-							   << itOrder.second->Price().Value()
-							   << ", new price: " << price.Value() );
+	ZUBR_LOG_INFO( "cancelling all " << m_openOrders.size()
+								   << " open orders: " << reason );
 
-				m_connector.Send<CancelOrderRequestWs>( itOrder.first );
+	// one write for the cancels, including those of the quoters
+	BeginBurst();
 
-				itOrder.second->Price( price );
-				itOrder.second->IsReplaceOrder( true );
-			}
-		}
+	if ( m_isAuthenticated ) {
+		cancelOpenOrders();
+	}
+
+	for ( auto & instrument : m_conf.Instruments() ) {
+		deliver( instrument.InstrumentId(), suspendEvent{ true } );
 	}
+
+	EndBurst();
+
+	pollCancelAll();
 }
 
-void bot::orderUpdateHandler( const OrderEntry & order )
+void bot::cancelOpenOrders()
 {
+	for ( auto & itOrder : m_openOrders ) {
+		if ( !itOrder.second.isCancelSent ) {
+			CancelOrder( itOrder.first );
+		}
+	}
+}
 
-	std::unordered_map<t_order_id, std::shared_ptr<PlaceOrderRequestWs>> &
-		ordersMap
-		= order.Direction() == OrderDirection::Buy ? m_buyOrdersMap
-												   : m_sellOrdersMap;
+void bot::pollCancelAll()
+{
+	if ( m_openOrders.empty() && m_orderReqMap.empty() ) {
+		ZUBR_LOG_INFO( "all orders cancelled" );
+	}
+	else if ( !m_isAuthenticated || t_clock::now() >= m_cancelAllDeadline ) {
+		ZUBR_LOG_ERROR( "cancel all incomplete, placements in flight: "
+						<< m_orderReqMap.size() );
+
+		for ( auto & itOrder : m_openOrders ) {
+			ZUBR_LOG_ERROR( "[" << itOrder.second.instrumentId
+								<< "] order may be left open: "
+								<< itOrder.first );
+		}
+	}
+	else {
+		m_connector.SetTimer( CancelAllPollMs, [this]() { pollCancelAll(); } );
+		return;
+	}
 
-	bool & isOrderPlaced = order.Direction() == OrderDirection::Buy
-							   ? m_isBuyOrderPlaced
-							   : m_isSellOrderPlaced;
+	m_isCancellingAll = false;
 
-	auto itOrderMap = ordersMap.find( order.Id() );
+	if ( m_isStopping ) {
+		m_connector.Stop();
+	}
+}
 
-	if ( ordersMap.end() != itOrderMap ) {
-		if ( order.Status() == OrderStatus::Filled
-			 || order.Status() == OrderStatus::PartiallyFilled ) {
+void bot::BeginBurst()
+{
+	++m_burstDepth;
+}
 
-			auto ordersFilledCount
-				= itOrderMap->second->Quantity() - order.QuantityRemaining();
+void bot::EndBurst()
+{
+	if ( --m_burstDepth == 0 && !m_burst.empty() ) {
+		sendBurst();
+	}
+}
 
-			if ( order.Direction() == OrderDirection::Buy ) {
-				m_positionSize += ordersFilledCount;
-			}
-			else if ( order.Direction() == OrderDirection::Sell ) {
-				m_positionSize -= ordersFilledCount;
-			}
+void bot::sendBurst()
+{
+	m_burstCancels.clear();
+	m_burstRequests.clear();
 
-			itOrderMap->second->Quantity( order.QuantityRemaining() );
+	// cancel requests are to keep their addresses
+	m_burstCancels.reserve( m_burst.size() );
 
-			if ( order.QuantityRemaining() == 0 ) {
-				ordersMap.erase( order.Id() );
-				isOrderPlaced = false;
-			}
+	for ( auto & cmd : m_burst ) {
+		if ( cmd.req ) {
+			m_burstRequests.push_back( cmd.req.get() );
 		}
-		else if ( order.Status() == OrderStatus::Cancelled ) {
-			if ( itOrderMap->second->IsReplaceOrder()
-				 && itOrderMap->second->Quantity() > 0 ) {
-
-				placeOrder( itOrderMap->second->Direction(),
-					itOrderMap->second->Quantity(),
-					itOrderMap->second->Direction() == OrderDirection::Buy
-						? m_isBuyOrderPlaced
-						: m_isSellOrderPlaced );
-			}
-			else {
-				isOrderPlaced = false;
-			}
+		else {
+			m_burstCancels.emplace_back( cmd.orderId );
+			m_burstRequests.push_back( &m_burstCancels.back() );
+		}
+	}
+
+	m_connector.SendBurst( m_burstRequests, m_burstIds );
 
-			ordersMap.erase( order.Id() );
+	auto now = t_clock::now();
+
+	for ( size_t i = 0; i < m_burst.size(); ++i ) {
+		if ( m_burst[i].req ) {
+			m_orderReqMap[m_burstIds[i]] = pendingOrder{ m_burst[i].req, now };
 		}
 	}
+
+	m_burst.clear();
 }
 
-void bot::connectHandler( zubr::AuthResponseWs & res )
+void bot::SetTimer( long milliseconds, const std::function<void()> & handler )
 {
-	if ( res.IsOk() ) {
+	// a timer on the client loop would keep it from running out of work
+	// and reconnecting, the handler is posted back once it fires
+	auto timer = std::make_shared<boost::asio::steady_timer>(
+		m_signalService, std::chrono::milliseconds( milliseconds ) );
+
+	timer->async_wait(
+		[this, timer, handler]( const boost::system::error_code & ec ) {
+			if ( !ec ) {
+				m_connector.Post( handler );
+			}
+		} );
+}
+
+void bot::OnResponse( zubr::AuthResponseWs & res )
+{
+	m_isAuthenticated = res.IsOk();
+
+	// orders of the previous connection can not be cancelled, the
+	// connector stops
+	if ( !res.IsOk() ) {
+		cancelAll( "authentication failure", true );
+	}
+	else {
 		m_connector.Send<zubr::SubscribeRequestWs>(
 			zubr::Channel::Instruments );
 
 		m_connector.Send<zubr::SubscribeRequestWs>( zubr::Channel::Orders );
+		m_connector.Send<zubr::SubscribeRequestWs>(
+			zubr::Channel::OrderFills );
 		m_connector.Send<zubr::SubscribeRequestWs>( zubr::Channel::OrderBook );
+		m_connector.Send<zubr::SubscribeRequestWs>(
+			zubr::Channel::LastTrades );
 		m_connector.Send<zubr::SubscribeRequestWs>( zubr::Channel::Positions );
+
+		for ( auto & instrument : m_conf.Instruments() ) {
+			deliver( instrument.InstrumentId(), connectedEvent{} );
+		}
 	}
 }
 
-void bot::messageHandler( zubr::ResponseWs & res )
+void bot::drainCommands()
 {
-	ZUBR_LOG_DEBUG(
-		"type: " << static_cast<int>( res.Type() ) << ", ok: " << res.IsOk() );
-
-	switch ( res.Type() ) {
-		case ResponseType::PlaceOrder: {
-			auto & r = static_cast<zubr::PlaceOrderResponseWs &>( res );
-			auto req = m_orderReqMap[r.Id()];
-
-			if ( !r.IsOk() ) {
-				if ( req->Direction() == OrderDirection::Buy ) {
-					ZUBR_LOG_ERROR(
-						"BUY order rejected: " << r.ErrorCodeName() );
-
-					m_isBuyOrderPlaced = false;
-				}
-				else if ( req->Direction() == OrderDirection::Sell ) {
-					ZUBR_LOG_ERROR(
-						"SELL order rejected: " << r.ErrorCodeName() );
-
-					m_isSellOrderPlaced = false;
-				}
-			}
-			else {
-				if ( req->Direction() == OrderDirection::Buy ) {
-					m_buyOrdersMap[r.OrderId()] = req;
-				}
-				else if ( req->Direction() == OrderDirection::Sell ) {
-					m_sellOrdersMap[r.OrderId()] = req;
-				}
-			}
+	// commands of all workers leave together
+	BeginBurst();
 
-			m_orderReqMap.erase( r.Id() );
-		} break;
+	m_dispatcher->Drain( [this]( orderCommand & cmd ) {
+		if ( cmd.resubscribeOrderBook ) {
+			ResubscribeOrderBook();
+		}
+		else if ( cmd.cancelAllReason ) {
+			CancelAll( cmd.cancelAllReason );
+		}
+		else if ( cmd.req ) {
+			PlaceOrder( cmd.req );
+		}
+		else {
+			CancelOrder( cmd.orderId );
+		}
+	} );
 
-		case zubr::ResponseType::ChannelInstruments: {
-			auto & r = static_cast<zubr::ChannelInstrumentsResponseWs &>( res );
-			auto it = r.List().find( m_conf.InstrumentId() );
+	EndBurst();
+}
 
-			if ( r.List().end() != it ) {
-				m_minPriceIncrement = it->second.MinPriceIncrement();
-			}
-		} break;
-
-		case zubr::ResponseType::ChannelOrderBook: {
-			auto & r = static_cast<zubr::ChannelOrderBookResponseWs &>( res );
-			auto it = r.Entries().find( m_conf.InstrumentId() );
-
-			if ( r.Entries().end() != it ) {
-				for ( size_t i = 0; i < it->second.Bids().size(); ++i ) {
-					auto & price = it->second.Bids()[i].Price();
-
-					if ( it->second.Bids()[i].Quantity() > 0 ) {
-						m_orderBookBid.insert( price );
-					}
-					else {
-						m_orderBookBid.erase( price );
-					}
-				}
-
-				for ( size_t i = 0; i < it->second.Asks().size(); ++i ) {
-					auto & price = it->second.Asks()[i].Price();
-
-					if ( it->second.Asks()[i].Quantity() > 0 ) {
-						m_orderBookAsk.insert( price );
-					}
-					else {
-						m_orderBookAsk.erase( price );
-					}
-				}
-
-				if ( !m_orderBookBid.empty() ) {
-					m_bestBuyPrice = *( --m_orderBookBid.end() );
-				}
-
-				if ( !m_orderBookAsk.empty() ) {
-					m_bestSellPrice = *( m_orderBookAsk.begin() );
-				}
-
-				ZUBR_LOG_INFO( "best BUY price: " << m_bestBuyPrice.Value()
-												  << "\tbest SELL price: "
-												  << m_bestSellPrice.Value() );
-			}
-		} break;
+void bot::OnResponse( zubr::PlaceOrderResponseWs & r )
+{
+	ZUBR_LOG_DEBUG( "place order: " << r.Id() << ", ok: " << r.IsOk() );
+
+	auto itReq = m_orderReqMap.find( r.Id() );
 
-		case zubr::ResponseType::ChannelPositions: {
-			auto & r = static_cast<zubr::ChannelPositionsResponseWs &>( res );
+	if ( m_orderReqMap.end() != itReq ) {
+		auto now = t_clock::now();
+		m_latencyMonitor.OnAck( now, now - itReq->second.sentAt );
 
-			if ( INT_MAX == m_positionSize ) {
-				auto it = r.Entries().find( m_conf.InstrumentId() );
-				m_positionSize
-					= r.Entries().end() != it ? it->second.Size() : 0;
+		if ( r.IsOk() ) {
+			m_openOrders[r.OrderId()]
+				= openOrder{ itReq->second.req->InstrumentId(), false };
 
-				ZUBR_LOG_INFO( "exchange position size: " << m_positionSize );
+			// placed before the halt
+			if ( m_isHalted ) {
+				CancelOrder( r.OrderId() );
 			}
-		} break;
+		}
 
-		case zubr::ResponseType::ChannelOrders: {
-			auto & r = static_cast<zubr::ChannelOrdersResponseWs &>( res );
+		deliver( itReq->second.req->InstrumentId(),
+			placeOrderResultEvent{ itReq->second.req, r } );
 
-			for ( auto & itOrder : r.Entries() ) {
-				orderUpdateHandler( itOrder.second );
-			}
-		} break;
+		m_orderReqMap.erase( r.Id() );
 	}
+}
 
-	if ( m_bestBuyPrice.HasValue() && m_bestSellPrice.HasValue()
-		 && m_minPriceIncrement.HasValue() && m_positionSize != INT_MAX ) {
+void bot::OnResponse( zubr::ChannelInstrumentsResponseWs & r )
+{
+	for ( auto & instrument : m_conf.Instruments() ) {
+		auto it = r.List().find( instrument.InstrumentId() );
 
-		if ( !m_isBuyOrderPlaced && m_positionSize < m_conf.PositionSizeMax()
-			 && m_buyOrdersMap.empty() ) {
+		if ( r.List().end() != it ) {
+			deliver( it->first, it->second );
+		}
+	}
+}
+
+void bot::OnResponse( zubr::ChannelOrderBookResponseWs & r )
+{
+	m_latencyMonitor.OnBook( t_clock::now() );
 
-			placeOrder(
-				OrderDirection::Buy, m_conf.Quantity(), m_isBuyOrderPlaced );
+	for ( auto & instrument : m_conf.Instruments() ) {
+		auto it = r.Entries().find( instrument.InstrumentId() );
+
+		if ( r.Entries().end() != it ) {
+			deliver( it->first, it->second );
 		}
+	}
 
-		if ( !m_isSellOrderPlaced && m_positionSize > -m_conf.PositionSizeMax()
-			 && m_sellOrdersMap.empty() ) {
+	ZUBR_LOG_DEBUG( "entries decoded: "
+					<< m_connector.Filter().DecodedCount()
+					<< ", skipped: " << m_connector.Filter().SkippedCount() );
+}
+
+void bot::OnResponse( zubr::ChannelPositionsResponseWs & r )
+{
+	// the snapshot omits flat instruments
+	if ( r.IsSnapshot() ) {
+		for ( auto & instrument : m_conf.Instruments() ) {
+			auto it = r.Entries().find( instrument.InstrumentId() );
+
+			deliver( instrument.InstrumentId(),
+				r.Entries().end() != it
+					? positionEvent( it->second, true )
+					: positionSizeEvent{ 0, true, 0 } );
+		}
+
+		return;
+	}
+
+	for ( auto & itPosition : r.Entries() ) {
+		deliver( itPosition.first, positionEvent( itPosition.second, false ) );
+	}
+}
+
+void bot::OnResponse( zubr::ChannelLastTradesResponseWs & r )
+{
+	auto now = t_clock::now();
+	auto nowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::system_clock::now().time_since_epoch() )
+					 .count();
+
+	for ( auto & itTrade : r.Entries() ) {
+		auto & trade = itTrade.second;
+
+		if ( !trade.Price().HasValue() ) {
+			continue;
+		}
+
+		// the exchange time is carried over to the local clock, snapshot
+		// trades are of the past
+		auto tradeTimeNs = trade.TradeTime().SinceEpochNs();
+		auto ageNs = ( tradeTimeNs > 0
+				? std::max<int64_t>( 0, nowNs - tradeTimeNs )
+				: 0 );
+
+		deliver( trade.InstrumentId(),
+			tradeEvent{ now
+					- std::chrono::duration_cast<t_clock::duration>(
+						std::chrono::nanoseconds( ageNs ) ),
+				trade.Price().Value(),
+				trade.Quantity(),
+				trade.Direction() } );
+	}
+}
+
+void bot::OnResponse( zubr::ChannelOrderFillsResponseWs & r )
+{
+	// history, the positions snapshot accounts for it
+	if ( r.IsSnapshot() ) {
+		return;
+	}
+
+	auto receivedAtNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::system_clock::now().time_since_epoch() )
+							.count();
+
+	for ( auto & itFill : r.Entries() ) {
+		auto & fill = itFill.second;
+
+		// the position is corrected by the next positions update
+		if ( !fill.Price().HasValue() ) {
+			ZUBR_LOG_ERROR( "[" << fill.InstrumentId() << "] fill of order "
+								<< fill.OrderId() << " without price, skipped" );
+
+			continue;
+		}
+
+		deliver( fill.InstrumentId(),
+			fillEvent{ fill.OrderId(),
+				fill.Direction(),
+				fill.Quantity(),
+				fill.Price().Value(),
+				fill.Fee(),
+				fill.TradeTime().SinceEpochNs(),
+				receivedAtNs } );
+	}
+}
+
+void bot::OnResponse( zubr::ChannelOrdersResponseWs & r )
+{
+	// every instrument gets its (possibly empty) list of open orders
+	if ( r.IsSnapshot() ) {
+		std::unordered_map<t_instrument_id, ordersSnapshotEvent> snapshots;
+
+		m_openOrders.clear();
+
+		for ( auto & instrument : m_conf.Instruments() ) {
+			snapshots[instrument.InstrumentId()];
+		}
+
+		for ( auto & itOrder : r.Entries() ) {
+			auto & order = itOrder.second;
+			auto it = snapshots.find( order.InstrumentId() );
+
+			if ( snapshots.end() != it ) {
+				it->second.orders.push_back( orderUpdateEvent{ order.Id(),
+					order.Direction(),
+					order.Status(),
+					order.QuantityRemaining() } );
+
+				m_openOrders[order.Id()]
+					= openOrder{ order.InstrumentId(), false };
+			}
+		}
+
+		BeginBurst();
+
+		// orders still open after a reconnect
+		if ( m_isHalted ) {
+			cancelOpenOrders();
+		}
+
+		for ( auto & itSnapshot : snapshots ) {
+			deliver( itSnapshot.first, itSnapshot.second );
+		}
+
+		EndBurst();
 
-			placeOrder(
-				OrderDirection::Sell, m_conf.Quantity(), m_isSellOrderPlaced );
+		return;
+	}
+
+	for ( auto & itOrder : r.Entries() ) {
+		auto & order = itOrder.second;
+
+		if ( order.Status() == OrderStatus::Filled
+			 || order.Status() == OrderStatus::Cancelled ) {
+
+			m_openOrders.erase( order.Id() );
 		}
 
-		ZUBR_LOG_INFO( "position size: " << m_positionSize );
+		deliver( order.InstrumentId(),
+			orderUpdateEvent{ order.Id(),
+				order.Direction(),
+				order.Status(),
+				order.QuantityRemaining() } );
+	}
+}
+
+void bot::onDisconnect()
+{
+	// responses to requests in flight never arrive
+	m_orderReqMap.clear();
+	m_latencyMonitor.Reset();
+	m_isAuthenticated = false;
+
+	for ( auto & instrument : m_conf.Instruments() ) {
+		deliver( instrument.InstrumentId(), resyncEvent{} );
+	}
+}
+
+void bot::onLatencyProbe( int64_t latencyUs )
+{
+	m_latencyMonitor.OnLoopLag( latencyUs );
+
+	// halted quoting does not resume
+	if ( m_isHalted ) {
+		return;
+	}
+
+	auto now = t_clock::now();
+	const char * reason = nullptr;
+
+	switch ( m_latencyMonitor.Check( now, reason ) ) {
+		case latencyMonitor::transition::Trip:
+			ZUBR_LOG_ERROR( "latency breaker tripped by " << reason
+							<< ", loop lag, us: " << latencyUs
+							<< ", ack round trip, us: "
+							<< m_latencyMonitor.AckRttUs( now )
+							<< ", suspending quoting" );
+
+			for ( auto & instrument : m_conf.Instruments() ) {
+				deliver( instrument.InstrumentId(), suspendEvent{ true } );
+			}
+
+			break;
+
+		case latencyMonitor::transition::Recover:
+			ZUBR_LOG_INFO( "latency recovered, resuming quoting" );
 
-		replaceOrderIfPriceChanged( OrderDirection::Buy );
-		replaceOrderIfPriceChanged( OrderDirection::Sell );
+			for ( auto & instrument : m_conf.Instruments() ) {
+				deliver( instrument.InstrumentId(), suspendEvent{ false } );
+			}
+
+			break;
+
+		default:
+			break;
 	}
 }
 
 void bot::start()
 {
+	ZUBR_LOG_INFO( "depth scan: " << DepthScan::Isa() );
+
+	if ( m_dispatcher ) {
+		m_dispatcher->Start();
+	}
+
 	m_connector.Start();
+
+	waitSignal();
+	m_signalThread = std::thread( [this]() { m_signalService.run(); } );
+}
+
+void bot::waitSignal()
+{
+	m_signals.async_wait(
+		[this]( const boost::system::error_code & ec, int signal ) {
+			if ( ec ) {
+				return;
+			}
+
+			if ( ++m_signalCount > 1 ) {
+				ZUBR_LOG_INFO( "signal " << signal << ", stopping now" );
+				m_connector.Stop();
+
+				return;
+			}
+
+			ZUBR_LOG_INFO( "signal " << signal << ", stopping" );
+			stop();
+
+			waitSignal();
+		} );
+}
+
+void bot::stop()
+{
+	m_connector.Post( [this]() { cancelAll( "stop", true ); } );
 }
 
 void bot::wait()
 {
 	m_connector.Wait();
+
+	if ( m_orderPool.FallbackCount() > 0 ) {
+		ZUBR_LOG_INFO( "order pool exhausted, heap allocations: "
+					   << m_orderPool.FallbackCount() );
+	}
+
+	// signals received from now on are left to the default handling
+	boost::system::error_code ec;
+	m_signals.clear( ec );
+	m_signalService.stop();
 }
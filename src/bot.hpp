@@ -31,87 +31,285 @@ SOFTWARE.
 #define __ZUBROBOT_BOT__H
 
 
-#include <set>
+#include <memory>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
 
+#include "boost/asio/signal_set.hpp"
+#include "boost/asio/steady_timer.hpp"
+
+#include "zubr-core/BlockPool.hpp"
+#include "zubr-core/FlatMap.hpp"
 #include "zubr-core/JsonSerializer.hpp"
 
 #include "zubr-connector-ws/ConnectorWs.hpp"
 
 #include "conf.hpp"
+#include "dispatcher.hpp"
+#include "latencyMonitor.hpp"
+#include "quotePolicy.hpp"
+#include "quoter.hpp"
 
 
 namespace zubr {
 
-	class bot {
+	/// @brief place order request waiting for the response
+	struct pendingOrder {
+		std::shared_ptr<PlaceOrderRequestWs> req;
+		t_clock::time_point sentAt;
+	};
+
+	/// @brief open order of any instrument, tracked on the connector thread
+	/// to be cancelled without the quoters
+	struct openOrder {
+		t_instrument_id instrumentId;
+		bool isCancelSent;
+	};
+
+	/// @brief routes connector messages to per instrument quoters sharing
+	/// one connection, quoters run either on the connector thread or on
+	/// dispatcher workers
+	class bot : public orderSink {
 	protected:
 		conf m_conf;
 
 		JsonSerializerFactory m_serializerFactory;
 
-		ConnectorWs m_connector;
+		StaticConnectorWs<bot> m_connector;
+
+		messageBudget m_messageBudget;
+
+		/// @brief place order requests are taken from the pool, it outlives
+		/// every holder of a request (quoters, workers, order tables); the
+		/// heap is used once OrderPoolSize requests are in flight
+		static constexpr uint32_t OrderPoolSize = 1024;
+		static constexpr size_t OrderPoolBlockSize = 256;
+
+		BlockPool m_orderPool;
+
+		std::unordered_map<t_instrument_id, std::unique_ptr<quoter>>
+			m_quoters;
 
-		Number m_minPriceIncrement;
-		Number m_bestBuyPrice;
-		Number m_bestSellPrice;
-		int m_positionSize;
+		/// @brief entries held by the order tables without rehashing
+		static constexpr size_t OrderTableCapacity = 1024;
 
-		bool m_isBuyOrderPlaced;
-		bool m_isSellOrderPlaced;
+		FlatMap<t_req_id, pendingOrder> m_orderReqMap;
+		FlatMap<t_order_id, openOrder> m_openOrders;
 
-		std::unordered_map<t_req_id, std::shared_ptr<PlaceOrderRequestWs>>
-			m_orderReqMap;
+		latencyMonitor m_latencyMonitor;
 
-		std::unordered_map<t_order_id, std::shared_ptr<PlaceOrderRequestWs>>
-			m_sellOrdersMap;
+		/// @brief confirmations of a cancel-all are waited for at most
+		/// CancelAllTimeoutMs, checked every CancelAllPollMs
+		static constexpr long CancelAllTimeoutMs = 3000;
+		static constexpr long CancelAllPollMs = 10;
 
-		std::unordered_map<t_order_id, std::shared_ptr<PlaceOrderRequestWs>>
-			m_buyOrdersMap;
+		bool m_isAuthenticated;
+		/// @brief placements are dropped, quoting does not resume
+		bool m_isHalted;
+		bool m_isCancellingAll;
+		/// @brief connector is stopped once the cancel-all completes
+		bool m_isStopping;
+		t_clock::time_point m_cancelAllDeadline;
 
-		std::set<Number> m_orderBookBid;
-		std::set<Number> m_orderBookAsk;
+		/// @brief SIGINT / SIGTERM and quoter timers are handled on a
+		/// thread of their own, the client loop is to run out of work
+		/// between connections
+		boost::asio::io_service m_signalService;
+		boost::asio::signal_set m_signals;
+		std::thread m_signalThread;
+		/// @brief signals received, signal thread only
+		int m_signalCount;
+
+		/// @brief order commands collected between BeginBurst() and
+		/// EndBurst()
+		int m_burstDepth;
+		std::vector<orderCommand> m_burst;
+		std::vector<CancelOrderRequestWs> m_burstCancels;
+		std::vector<RequestWs *> m_burstRequests;
+		std::vector<t_req_id> m_burstIds;
+
+		std::unique_ptr<dispatcher> m_dispatcher;
+
+		/// @brief one resubscription serves every instrument
+		static constexpr long OrderBookResubscribeIntervalMs = 1000;
+		t_clock::time_point m_orderBookResubscribeAt;
 
 	protected:
-		Number calculateOrderPrice( OrderDirection direction );
-		void placeOrder(
-			OrderDirection direction, int quantity, bool & isPlaced );
+		quoter * findQuoter( t_instrument_id instrumentId );
+
+		static positionSizeEvent positionEvent(
+			const Position & position, bool isSnapshot )
+		{
+
+			auto & entryPrice = position.EntryPrice();
+
+			return positionSizeEvent{ position.Size(),
+				isSnapshot,
+				entryPrice.HasValue() ? entryPrice.Value() : 0 };
+		}
+
+		/// @brief pass event to the quoter of the instrument
+		template <typename TEvent>
+		void deliver( t_instrument_id instrumentId, const TEvent & ev )
+		{
+			if ( m_dispatcher ) {
+				m_dispatcher->Post( instrumentId, ev );
+				return;
+			}
+
+			auto q = findQuoter( instrumentId );
+
+			if ( q ) {
+				q->OnEvent( ev );
+			}
+		}
+
+		/// @brief send order commands queued by workers
+		void drainCommands();
 
-		void replaceOrderIfPriceChanged( OrderDirection direction );
+		/// @brief start resynchronization of every quoter
+		void onDisconnect();
 
-		void orderUpdateHandler( const OrderEntry & order );
+		/// @brief send collected order commands as one burst
+		void sendBurst();
 
-		void connectHandler( zubr::AuthResponseWs & res );
+		/// @brief cancel every tracked order, halt quoting and wait for
+		/// the confirmations
+		/// @param reason for logging
+		/// @param isStopping stop the connector once done
+		void cancelAll( const char * reason, bool isStopping );
 
-		/// @brief main handler for incoming messages
-		/// @param res
-		void messageHandler( zubr::ResponseWs & res );
+		/// @brief cancel tracked orders with no cancel sent yet
+		void cancelOpenOrders();
+
+		/// @brief complete the cancel-all once no order is open or the
+		/// deadline passes
+		void pollCancelAll();
+
+		/// @brief wait for SIGINT / SIGTERM, the first cancels all orders
+		/// and stops, the second stops at once
+		void waitSignal();
+
+		/// @brief evaluate the circuit breaker, suspend or resume quoting
+		/// @param latencyUs loop wake latency sample
+		void onLatencyProbe( int64_t latencyUs );
 
 	public:
 		bot( const conf & conf )
 			: m_conf( conf )
 			, m_serializerFactory()
-			, m_connector( conf.Api().KeyId(),
+			, m_connector( *this,
+				  conf.Api().KeyId(),
 				  conf.Api().KeySecret(),
 				  m_serializerFactory,
 				  conf.Api().Url(),
 				  conf.Api().Host() )
-			, m_isBuyOrderPlaced( false )
-			, m_isSellOrderPlaced( false )
+			, m_messageBudget( conf.QuotePolicy().MessagesPerSecond() )
+			, m_orderPool( OrderPoolBlockSize, OrderPoolSize )
+			, m_orderReqMap( OrderTableCapacity )
+			, m_openOrders( OrderTableCapacity )
+			, m_latencyMonitor( conf.Latency() )
+			, m_isAuthenticated( false )
+			, m_isHalted( false )
+			, m_isCancellingAll( false )
+			, m_isStopping( false )
+			, m_signals( m_signalService, SIGINT, SIGTERM )
+			, m_signalCount( 0 )
+			, m_burstDepth( 0 )
 		{
 
-			m_positionSize = conf.UseConfigStartPositionSize()
-								 ? conf.PositionSizeStart()
-								 : INT_MAX;
+			std::unordered_set<t_instrument_id> instrumentIds;
+
+			for ( auto & instrument : conf.Instruments() ) {
+				instrumentIds.insert( instrument.InstrumentId() );
+			}
+
+			m_connector.SetInstrumentFilter( instrumentIds );
+
+			ClientThreadOptions clientThreadOptions;
+			clientThreadOptions.cpu = conf.Network().Cpu();
+			clientThreadOptions.fifoPriority = conf.Network().FifoPriority();
+			clientThreadOptions.busyPoll = conf.Network().BusyPoll();
+			clientThreadOptions.socketBusyPollUs
+				= conf.Network().SocketBusyPollUs();
+
+			m_connector.SetClientThreadOptions( clientThreadOptions );
+
+			auto & socketConf = conf.Socket();
+
+			SocketOptions socketOptions;
+			socketOptions.noDelay = socketConf.NoDelay();
+			socketOptions.quickAck = socketConf.QuickAck();
+			socketOptions.rcvBuf = socketConf.RcvBuf();
+			socketOptions.sndBuf = socketConf.SndBuf();
+			socketOptions.tos = socketConf.Tos();
+			socketOptions.keepAlive = socketConf.KeepAlive();
+			socketOptions.keepAliveIdleS = socketConf.KeepAliveIdleS();
+			socketOptions.keepAliveIntervalS = socketConf.KeepAliveIntervalS();
+			socketOptions.keepAliveCount = socketConf.KeepAliveCount();
+
+			m_connector.SetSocketOptions( socketOptions );
+			m_connector.SetDisconnectHandler( [this]() { onDisconnect(); } );
+
+			if ( conf.Latency().IsEnabled() ) {
+				m_connector.SetLatencyProbeHandler(
+					[this]( int64_t latencyUs ) { onLatencyProbe( latencyUs ); } );
+			}
+
+			if ( conf.Workers().Count() > 0 ) {
+				m_dispatcher.reset(
+					new dispatcher( conf, m_orderPool, [this]() {
+						m_connector.Post( [this]() { drainCommands(); } );
+					} ) );
+			}
+			else {
+				for ( auto & instrument : conf.Instruments() ) {
+					m_quoters[instrument.InstrumentId()].reset( new quoter(
+						instrument, *this, m_messageBudget, m_orderPool ) );
+				}
+			}
+		}
 
-			m_connector.SetConnectHandler( std::bind(
-				&bot::connectHandler, this, std::placeholders::_1 ) );
+		~bot()
+		{
+			m_signalService.stop();
 
-			m_connector.SetMessageHandler( std::bind(
-				&bot::messageHandler, this, std::placeholders::_1 ) );
+			if ( m_signalThread.joinable() ) {
+				m_signalThread.join();
+			}
 		}
 
+		/// @brief response handlers, called by the connector directly
+		void OnResponse( zubr::AuthResponseWs & r );
+		void OnResponse( zubr::PlaceOrderResponseWs & r );
+		void OnResponse( zubr::ChannelInstrumentsResponseWs & r );
+		void OnResponse( zubr::ChannelOrderBookResponseWs & r );
+		void OnResponse( zubr::ChannelPositionsResponseWs & r );
+		void OnResponse( zubr::ChannelOrdersResponseWs & r );
+		void OnResponse( zubr::ChannelOrderFillsResponseWs & r );
+		void OnResponse( zubr::ChannelLastTradesResponseWs & r );
+
+		void PlaceOrder(
+			const std::shared_ptr<PlaceOrderRequestWs> & req ) override;
+
+		void CancelOrder( t_order_id orderId ) override;
+
+		void ResubscribeOrderBook() override;
+
+		void CancelAll( const char * reason ) override;
+
+		void BeginBurst() override;
+		void EndBurst() override;
+
+		void SetTimer( long milliseconds,
+			const std::function<void()> & handler ) override;
+
 		void start();
 		void wait();
+
+		/// @brief cancel all orders and stop (thread safe)
+		void stop();
 	};
 
 } // namespace zubr
@@ -47,22 +47,300 @@ void confApi::Deserialize( rapidjson::Value & v )
 }
 
 
+void confQuotePolicy::Deserialize( rapidjson::Value & v )
+{
+	if ( v.HasMember( "minTickDistance" ) ) {
+		m_minTickDistance = v["minTickDistance"].GetInt();
+	}
+
+	if ( v.HasMember( "minRequoteIntervalMs" ) ) {
+		m_minRequoteIntervalMs = v["minRequoteIntervalMs"].GetInt();
+	}
+
+	if ( v.HasMember( "messagesPerSecond" ) ) {
+		m_messagesPerSecond = v["messagesPerSecond"].GetInt();
+	}
+}
+
+
+void confPricing::Deserialize( rapidjson::Value & v )
+{
+	if ( v.HasMember( "reference" ) ) {
+		std::string stringValue = v["reference"].GetString();
+
+		if ( stringValue == "microprice" ) {
+			m_reference = priceReference::Microprice;
+		}
+		else if ( stringValue == "depthWeightedMid" ) {
+			m_reference = priceReference::DepthWeightedMid;
+		}
+		else {
+			m_reference = priceReference::Mid;
+		}
+	}
+
+	if ( v.HasMember( "depthTicks" ) ) {
+		m_depthTicks = v["depthTicks"].GetInt();
+	}
+
+	if ( v.HasMember( "imbalanceTicks" ) ) {
+		m_imbalanceTicks = v["imbalanceTicks"].GetInt();
+	}
+
+	if ( v.HasMember( "imbalanceSkew" ) ) {
+		m_imbalanceSkew = v["imbalanceSkew"].GetDouble();
+	}
+}
+
+
+void confLadder::Deserialize( rapidjson::Value & v )
+{
+	m_levels.clear();
+
+	if ( v.HasMember( "levels" ) ) {
+		auto levels = v["levels"].GetArray();
+
+		for ( rapidjson::SizeType i = 0; i < levels.Size(); ++i ) {
+			m_levels.push_back( confLadderLevel{
+				levels[i]["offsetTicks"].GetInt(),
+				levels[i]["quantity"].GetInt() } );
+		}
+	}
+}
+
+
+void confRisk::Deserialize( rapidjson::Value & v )
+{
+	if ( v.HasMember( "maxOrderQuantity" ) ) {
+		m_maxOrderQuantity = v["maxOrderQuantity"].GetInt();
+	}
+
+	if ( v.HasMember( "maxOpenOrders" ) ) {
+		m_maxOpenOrders = v["maxOpenOrders"].GetInt();
+	}
+
+	if ( v.HasMember( "maxOpenQuantity" ) ) {
+		m_maxOpenQuantity = v["maxOpenQuantity"].GetInt();
+	}
+
+	if ( v.HasMember( "maxNotional" ) ) {
+		m_maxNotional = v["maxNotional"].GetDouble();
+	}
+
+	if ( v.HasMember( "priceBandPercent" ) ) {
+		m_priceBandPercent = v["priceBandPercent"].GetDouble();
+	}
+
+	if ( v.HasMember( "maxMessagesPerSecond" ) ) {
+		m_maxMessagesPerSecond = v["maxMessagesPerSecond"].GetInt();
+	}
+
+	if ( v.HasMember( "maxPosition" ) ) {
+		m_maxPosition = v["maxPosition"].GetInt();
+	}
+}
+
+
+void confTape::Deserialize( rapidjson::Value & v )
+{
+	if ( v.HasMember( "capacity" ) ) {
+		m_capacity = v["capacity"].GetInt();
+	}
+
+	if ( v.HasMember( "windowMs" ) ) {
+		m_windowMs = v["windowMs"].GetInt();
+	}
+
+	if ( v.HasMember( "volatilityFactor" ) ) {
+		m_volatilityFactor = v["volatilityFactor"].GetDouble();
+	}
+
+	if ( v.HasMember( "maxInterest" ) ) {
+		m_maxInterest = v["maxInterest"].GetDouble();
+	}
+}
+
+
+void confInstrument::Deserialize( rapidjson::Value & v )
+{
+	if ( v.HasMember( "instrumentId" ) ) {
+		m_instrumentId = v["instrumentId"].GetInt();
+	}
+
+	if ( v.HasMember( "quantity" ) ) {
+		m_quantity = v["quantity"].GetInt();
+	}
+
+	if ( v.HasMember( "positionSizeStart" ) ) {
+		m_positionSizeStart = v["positionSizeStart"].GetInt();
+	}
+
+	if ( v.HasMember( "positionSizeMax" ) ) {
+		m_positionSizeMax = v["positionSizeMax"].GetInt();
+	}
+
+	if ( v.HasMember( "shift" ) ) {
+		m_shift = v["shift"].GetDouble();
+	}
+
+	if ( v.HasMember( "interest" ) ) {
+		m_interest = v["interest"].GetDouble();
+	}
+
+	if ( v.HasMember( "useConfigStartPositionSize" ) ) {
+		m_useConfigStartPositionSize
+			= v["useConfigStartPositionSize"].GetBool();
+	}
+
+	if ( v.HasMember( "quotePolicy" ) ) {
+		m_quotePolicy.Deserialize( v["quotePolicy"] );
+	}
+
+	if ( v.HasMember( "pricing" ) ) {
+		m_pricing.Deserialize( v["pricing"] );
+	}
+
+	if ( v.HasMember( "ladder" ) ) {
+		m_ladder.Deserialize( v["ladder"] );
+	}
+
+	if ( v.HasMember( "risk" ) ) {
+		m_risk.Deserialize( v["risk"] );
+	}
+
+	if ( v.HasMember( "tape" ) ) {
+		m_tape.Deserialize( v["tape"] );
+	}
+}
+
+
+void confLatency::Deserialize( rapidjson::Value & v )
+{
+	if ( v.HasMember( "maxLoopLagUs" ) ) {
+		m_maxLoopLagUs = v["maxLoopLagUs"].GetInt();
+	}
+
+	if ( v.HasMember( "maxAckRttUs" ) ) {
+		m_maxAckRttUs = v["maxAckRttUs"].GetInt();
+	}
+
+	if ( v.HasMember( "ackRttPercentile" ) ) {
+		m_ackRttPercentile = v["ackRttPercentile"].GetDouble();
+	}
+
+	if ( v.HasMember( "maxBookAgeMs" ) ) {
+		m_maxBookAgeMs = v["maxBookAgeMs"].GetInt();
+	}
+
+	if ( v.HasMember( "windowMs" ) ) {
+		m_windowMs = v["windowMs"].GetInt();
+	}
+
+	if ( v.HasMember( "recoveryMs" ) ) {
+		m_recoveryMs = v["recoveryMs"].GetInt();
+	}
+}
+
+
+void confWorkers::Deserialize( rapidjson::Value & v )
+{
+	m_count = v["count"].GetInt();
+
+	if ( v.HasMember( "cpus" ) ) {
+		auto cpus = v["cpus"].GetArray();
+
+		for ( rapidjson::SizeType i = 0; i < cpus.Size(); ++i ) {
+			m_cpus.push_back( cpus[i].GetInt() );
+		}
+	}
+}
+
+
+void confNetwork::Deserialize( rapidjson::Value & v )
+{
+	if ( v.HasMember( "cpu" ) ) {
+		m_cpu = v["cpu"].GetInt();
+	}
+
+	if ( v.HasMember( "fifoPriority" ) ) {
+		m_fifoPriority = v["fifoPriority"].GetInt();
+	}
+
+	if ( v.HasMember( "busyPoll" ) ) {
+		m_busyPoll = v["busyPoll"].GetBool();
+	}
+
+	if ( v.HasMember( "socketBusyPollUs" ) ) {
+		m_socketBusyPollUs = v["socketBusyPollUs"].GetInt();
+	}
+}
+
+
+void confSocket::Deserialize( rapidjson::Value & v )
+{
+	if ( v.HasMember( "noDelay" ) ) {
+		m_noDelay = v["noDelay"].GetBool() ? 1 : 0;
+	}
+
+	if ( v.HasMember( "quickAck" ) ) {
+		m_quickAck = v["quickAck"].GetBool() ? 1 : 0;
+	}
+
+	if ( v.HasMember( "rcvBuf" ) ) {
+		m_rcvBuf = v["rcvBuf"].GetInt();
+	}
+
+	if ( v.HasMember( "sndBuf" ) ) {
+		m_sndBuf = v["sndBuf"].GetInt();
+	}
+
+	if ( v.HasMember( "tos" ) ) {
+		m_tos = v["tos"].GetInt();
+	}
+
+	if ( v.HasMember( "keepAlive" ) ) {
+		m_keepAlive = v["keepAlive"].GetBool() ? 1 : 0;
+	}
+
+	if ( v.HasMember( "keepAliveIdleS" ) ) {
+		m_keepAliveIdleS = v["keepAliveIdleS"].GetInt();
+	}
+
+	if ( v.HasMember( "keepAliveIntervalS" ) ) {
+		m_keepAliveIntervalS = v["keepAliveIntervalS"].GetInt();
+	}
+
+	if ( v.HasMember( "keepAliveCount" ) ) {
+		m_keepAliveCount = v["keepAliveCount"].GetInt();
+	}
+}
+
+
 void conf::LoadJson( const std::string & json )
 {
 	if ( json.empty() ) {
 		throw zubr::Exception();
 	}
 
+	// comments allow alternatives to be kept in the file disabled
 	rapidjson::Document doc;
-	doc.Parse( json.c_str() );
+	doc.Parse<rapidjson::kParseCommentsFlag>( json.c_str() );
+
+	confInstrument defaults;
+	defaults.Deserialize( doc );
 
-	m_instrumentId = doc["instrumentId"].GetInt();
-	m_quantity = doc["quantity"].GetInt();
-	m_positionSizeStart = doc["positionSizeStart"].GetInt();
-	m_positionSizeMax = doc["positionSizeMax"].GetInt();
-	m_shift = doc["shift"].GetDouble();
-	m_interest = doc["interest"].GetDouble();
-	m_useConfigStartPositionSize = doc["useConfigStartPositionSize"].GetBool();
+	if ( doc.HasMember( "instruments" ) ) {
+		auto instruments = doc["instruments"].GetArray();
+
+		for ( rapidjson::SizeType i = 0; i < instruments.Size(); ++i ) {
+			confInstrument instrument( defaults );
+			instrument.Deserialize( instruments[i] );
+			m_instruments.push_back( instrument );
+		}
+	}
+	else {
+		m_instruments.push_back( defaults );
+	}
 
 	std::string stringValue = doc["logLevel"].GetString();
 
@@ -77,6 +355,26 @@ void conf::LoadJson( const std::string & json )
 	}
 
 	m_api.Deserialize( doc["api"] );
+
+	if ( doc.HasMember( "quotePolicy" ) ) {
+		m_quotePolicy.Deserialize( doc["quotePolicy"] );
+	}
+
+	if ( doc.HasMember( "latency" ) ) {
+		m_latency.Deserialize( doc["latency"] );
+	}
+
+	if ( doc.HasMember( "workers" ) ) {
+		m_workers.Deserialize( doc["workers"] );
+	}
+
+	if ( doc.HasMember( "network" ) ) {
+		m_network.Deserialize( doc["network"] );
+	}
+
+	if ( doc.HasMember( "socket" ) ) {
+		m_socket.Deserialize( doc["socket"] );
+	}
 }
 
 void conf::LoadFile( const std::string & filename )
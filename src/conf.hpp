@@ -32,6 +32,7 @@ SOFTWARE.
 
 
 #include <string>
+#include <vector>
 
 #include "rapidjson/document.h"
 
@@ -71,10 +72,240 @@ namespace zubr {
 		}
 	};
 
-	class conf {
+	/// @brief requote throttling parameters
+	class confQuotePolicy {
 	protected:
-		confApi m_api;
+		int m_minTickDistance;
+		int m_minRequoteIntervalMs;
+		int m_messagesPerSecond;
+
+	public:
+		confQuotePolicy()
+			: m_minTickDistance( 1 )
+			, m_minRequoteIntervalMs( 0 )
+			, m_messagesPerSecond( 0 )
+		{
+		}
+
+		void Deserialize( rapidjson::Value & v );
+
+		/// @brief minimum price change (in ticks) worth a requote
+		int MinTickDistance() const
+		{
+			return m_minTickDistance;
+		}
+
+		/// @brief minimum time between requotes of the same side (0 - off)
+		int MinRequoteIntervalMs() const
+		{
+			return m_minRequoteIntervalMs;
+		}
+
+		/// @brief outbound order messages allowed per rolling second (0 - off)
+		int MessagesPerSecond() const
+		{
+			return m_messagesPerSecond;
+		}
+	};
+
+	/// @brief price the quotes are built around
+	enum class priceReference {
+		Mid,
+		Microprice,
+		DepthWeightedMid
+	};
+
+	/// @brief order book derived pricing parameters
+	class confPricing {
+	protected:
+		priceReference m_reference;
+		int m_depthTicks;
+		int m_imbalanceTicks;
+		double m_imbalanceSkew;
+
+	public:
+		confPricing()
+			: m_reference( priceReference::Mid )
+			, m_depthTicks( 5 )
+			, m_imbalanceTicks( 1 )
+			, m_imbalanceSkew( 0 )
+		{
+		}
+
+		void Deserialize( rapidjson::Value & v );
+
+		priceReference Reference() const
+		{
+			return m_reference;
+		}
+
+		/// @brief depth band (in ticks from the best price) of the depth
+		/// weighted mid and cumulative depth
+		int DepthTicks() const
+		{
+			return m_depthTicks;
+		}
+
+		/// @brief depth band (in ticks from the best price) of the imbalance
+		int ImbalanceTicks() const
+		{
+			return m_imbalanceTicks;
+		}
+
+		/// @brief price shift per unit of imbalance (-1 .. 1), added to the
+		/// reference price
+		double ImbalanceSkew() const
+		{
+			return m_imbalanceSkew;
+		}
+	};
+
+	/// @brief ladder level, offset from the quote price away from the touch
+	struct confLadderLevel {
+		int offsetTicks;
+		int quantity;
+	};
+
+	/// @brief resting orders per side, a single order of Quantity() if
+	/// empty
+	class confLadder {
+	protected:
+		std::vector<confLadderLevel> m_levels;
+
+	public:
+		void Deserialize( rapidjson::Value & v );
+
+		const std::vector<confLadderLevel> & Levels() const
+		{
+			return m_levels;
+		}
+
+		bool IsEnabled() const
+		{
+			return !m_levels.empty();
+		}
+	};
+
+	/// @brief pre-trade limits, 0 - no limit
+	class confRisk {
+	protected:
+		int m_maxOrderQuantity;
+		int m_maxOpenOrders;
+		int m_maxOpenQuantity;
+		double m_maxNotional;
+		double m_priceBandPercent;
+		int m_maxMessagesPerSecond;
+		int m_maxPosition;
+
+	public:
+		confRisk()
+			: m_maxOrderQuantity( 0 )
+			, m_maxOpenOrders( 0 )
+			, m_maxOpenQuantity( 0 )
+			, m_maxNotional( 0 )
+			, m_priceBandPercent( 0 )
+			, m_maxMessagesPerSecond( 0 )
+			, m_maxPosition( 0 )
+		{
+		}
+
+		void Deserialize( rapidjson::Value & v );
+
+		/// @brief larger orders are clipped
+		int MaxOrderQuantity() const
+		{
+			return m_maxOrderQuantity;
+		}
 
+		/// @brief placements are rejected at the limit
+		int MaxOpenOrders() const
+		{
+			return m_maxOpenOrders;
+		}
+
+		/// @brief open quantity per side, orders are clipped to fit
+		int MaxOpenQuantity() const
+		{
+			return m_maxOpenQuantity;
+		}
+
+		/// @brief notional of the position plus open orders per side if all
+		/// filled, orders are clipped to fit
+		double MaxNotional() const
+		{
+			return m_maxNotional;
+		}
+
+		/// @brief maximum distance of the order price from the reference
+		/// price, in percent of the latter
+		double PriceBandPercent() const
+		{
+			return m_priceBandPercent;
+		}
+
+		/// @brief order messages (placements and cancels) per rolling
+		/// second, placements are rejected at the limit
+		int MaxMessagesPerSecond() const
+		{
+			return m_maxMessagesPerSecond;
+		}
+
+		/// @brief absolute position beyond which every order is cancelled
+		/// and quoting halts
+		int MaxPosition() const
+		{
+			return m_maxPosition;
+		}
+	};
+
+	/// @brief public trades statistics and the interest they widen
+	class confTape {
+	protected:
+		int m_capacity;
+		int m_windowMs;
+		double m_volatilityFactor;
+		double m_maxInterest;
+
+	public:
+		confTape()
+			: m_capacity( 1024 )
+			, m_windowMs( 10000 )
+			, m_volatilityFactor( 0 )
+			, m_maxInterest( 0 )
+		{
+		}
+
+		void Deserialize( rapidjson::Value & v );
+
+		/// @brief trades kept, the oldest leave the window once exceeded
+		int Capacity() const
+		{
+			return m_capacity;
+		}
+
+		/// @brief statistics cover trades not older than this
+		int WindowMs() const
+		{
+			return m_windowMs;
+		}
+
+		/// @brief interest added per unit of the price move the realized
+		/// volatility of the window amounts to, 0 - fixed interest
+		double VolatilityFactor() const
+		{
+			return m_volatilityFactor;
+		}
+
+		/// @brief widened interest limit, 0 - no limit
+		double MaxInterest() const
+		{
+			return m_maxInterest;
+		}
+	};
+
+	/// @brief quoting parameters of a single instrument
+	class confInstrument {
+	protected:
 		int m_instrumentId;
 		int m_quantity;
 		int m_positionSizeStart;
@@ -82,14 +313,28 @@ namespace zubr {
 		double m_shift;
 		double m_interest;
 		bool m_useConfigStartPositionSize;
-		zubr::LogLevel m_logLevel;
+		confQuotePolicy m_quotePolicy;
+		confPricing m_pricing;
+		confLadder m_ladder;
+		confRisk m_risk;
+		confTape m_tape;
 
 	public:
-		const confApi & Api() const
+		confInstrument()
+			: m_instrumentId( 0 )
+			, m_quantity( 0 )
+			, m_positionSizeStart( 0 )
+			, m_positionSizeMax( 0 )
+			, m_shift( 0 )
+			, m_interest( 0 )
+			, m_useConfigStartPositionSize( false )
 		{
-			return m_api;
 		}
 
+		/// @brief read parameters present in v, keep the rest
+		/// @param v
+		void Deserialize( rapidjson::Value & v );
+
 		int InstrumentId() const
 		{
 			return m_instrumentId;
@@ -125,6 +370,304 @@ namespace zubr {
 			return m_useConfigStartPositionSize;
 		}
 
+		const confQuotePolicy & QuotePolicy() const
+		{
+			return m_quotePolicy;
+		}
+
+		const confPricing & Pricing() const
+		{
+			return m_pricing;
+		}
+
+		const confLadder & Ladder() const
+		{
+			return m_ladder;
+		}
+
+		const confRisk & Risk() const
+		{
+			return m_risk;
+		}
+
+		const confTape & Tape() const
+		{
+			return m_tape;
+		}
+	};
+
+	/// @brief strategy worker threads
+	class confWorkers {
+	protected:
+		int m_count;
+		std::vector<int> m_cpus;
+
+	public:
+		confWorkers()
+			: m_count( 0 )
+		{
+		}
+
+		void Deserialize( rapidjson::Value & v );
+
+		/// @brief worker thread count, 0 - quote on the connector thread
+		int Count() const
+		{
+			return m_count;
+		}
+
+		/// @brief CPU to pin each worker to, unpinned if missing
+		const std::vector<int> & Cpus() const
+		{
+			return m_cpus;
+		}
+	};
+
+	/// @brief connector (network) thread
+	class confNetwork {
+	protected:
+		int m_cpu;
+		int m_fifoPriority;
+		bool m_busyPoll;
+		int m_socketBusyPollUs;
+
+	public:
+		confNetwork()
+			: m_cpu( -1 )
+			, m_fifoPriority( 0 )
+			, m_busyPoll( false )
+			, m_socketBusyPollUs( 0 )
+		{
+		}
+
+		void Deserialize( rapidjson::Value & v );
+
+		/// @brief CPU to pin the connector thread to, -1 - unpinned
+		int Cpu() const
+		{
+			return m_cpu;
+		}
+
+		/// @brief SCHED_FIFO priority, 0 - default scheduling
+		int FifoPriority() const
+		{
+			return m_fifoPriority;
+		}
+
+		/// @brief spin polling the event loop instead of blocking
+		bool BusyPoll() const
+		{
+			return m_busyPoll;
+		}
+
+		/// @brief SO_BUSY_POLL of the socket, microseconds, 0 - off
+		int SocketBusyPollUs() const
+		{
+			return m_socketBusyPollUs;
+		}
+	};
+
+	/// @brief socket options, -1 - system default, flags are 0 / 1
+	class confSocket {
+	protected:
+		int m_noDelay;
+		int m_quickAck;
+		int m_rcvBuf;
+		int m_sndBuf;
+		int m_tos;
+		int m_keepAlive;
+		int m_keepAliveIdleS;
+		int m_keepAliveIntervalS;
+		int m_keepAliveCount;
+
+	public:
+		confSocket()
+			: m_noDelay( -1 )
+			, m_quickAck( -1 )
+			, m_rcvBuf( -1 )
+			, m_sndBuf( -1 )
+			, m_tos( -1 )
+			, m_keepAlive( -1 )
+			, m_keepAliveIdleS( -1 )
+			, m_keepAliveIntervalS( -1 )
+			, m_keepAliveCount( -1 )
+		{
+		}
+
+		void Deserialize( rapidjson::Value & v );
+
+		/// @brief disable Nagle's algorithm
+		int NoDelay() const
+		{
+			return m_noDelay;
+		}
+
+		/// @brief acknowledge received data immediately
+		int QuickAck() const
+		{
+			return m_quickAck;
+		}
+
+		/// @brief receive buffer, bytes
+		int RcvBuf() const
+		{
+			return m_rcvBuf;
+		}
+
+		/// @brief send buffer, bytes
+		int SndBuf() const
+		{
+			return m_sndBuf;
+		}
+
+		/// @brief IP type of service
+		int Tos() const
+		{
+			return m_tos;
+		}
+
+		/// @brief enable TCP keepalive
+		int KeepAlive() const
+		{
+			return m_keepAlive;
+		}
+
+		/// @brief idle time before keepalive probes, seconds
+		int KeepAliveIdleS() const
+		{
+			return m_keepAliveIdleS;
+		}
+
+		/// @brief interval between keepalive probes, seconds
+		int KeepAliveIntervalS() const
+		{
+			return m_keepAliveIntervalS;
+		}
+
+		/// @brief unanswered keepalive probes before drop
+		int KeepAliveCount() const
+		{
+			return m_keepAliveCount;
+		}
+	};
+
+	/// @brief latency circuit breaker thresholds, 0 - trigger is off
+	class confLatency {
+	protected:
+		int m_maxLoopLagUs;
+		int m_maxAckRttUs;
+		double m_ackRttPercentile;
+		int m_maxBookAgeMs;
+		int m_windowMs;
+		int m_recoveryMs;
+
+	public:
+		confLatency()
+			: m_maxLoopLagUs( 0 )
+			, m_maxAckRttUs( 0 )
+			, m_ackRttPercentile( 99 )
+			, m_maxBookAgeMs( 0 )
+			, m_windowMs( 10000 )
+			, m_recoveryMs( 1000 )
+		{
+		}
+
+		void Deserialize( rapidjson::Value & v );
+
+		/// @brief delay of the event loop handling a due timer, incoming
+		/// messages wait in the socket at least as long
+		int MaxLoopLagUs() const
+		{
+			return m_maxLoopLagUs;
+		}
+
+		/// @brief place order round trip at AckRttPercentile()
+		int MaxAckRttUs() const
+		{
+			return m_maxAckRttUs;
+		}
+
+		double AckRttPercentile() const
+		{
+			return m_ackRttPercentile;
+		}
+
+		/// @brief time since the last order book message
+		int MaxBookAgeMs() const
+		{
+			return m_maxBookAgeMs;
+		}
+
+		/// @brief round trips older than this are not counted
+		int WindowMs() const
+		{
+			return m_windowMs;
+		}
+
+		/// @brief time every trigger is to stay below its threshold before
+		/// quoting resumes
+		int RecoveryMs() const
+		{
+			return m_recoveryMs;
+		}
+
+		bool IsEnabled() const
+		{
+			return ( m_maxLoopLagUs > 0 || m_maxAckRttUs > 0
+				|| m_maxBookAgeMs > 0 );
+		}
+	};
+
+	class conf {
+	protected:
+		confApi m_api;
+		confQuotePolicy m_quotePolicy;
+		confLatency m_latency;
+		confWorkers m_workers;
+		confNetwork m_network;
+		confSocket m_socket;
+		std::vector<confInstrument> m_instruments;
+		zubr::LogLevel m_logLevel;
+
+	public:
+		const confApi & Api() const
+		{
+			return m_api;
+		}
+
+		/// @brief connection wide quote policy (message budget)
+		const confQuotePolicy & QuotePolicy() const
+		{
+			return m_quotePolicy;
+		}
+
+		const confLatency & Latency() const
+		{
+			return m_latency;
+		}
+
+		const confWorkers & Workers() const
+		{
+			return m_workers;
+		}
+
+		const confNetwork & Network() const
+		{
+			return m_network;
+		}
+
+		const confSocket & Socket() const
+		{
+			return m_socket;
+		}
+
+		/// @brief quoted instruments, top level parameters are the defaults
+		/// for every "instruments" entry
+		const std::vector<confInstrument> & Instruments() const
+		{
+			return m_instruments;
+		}
+
 		zubr::LogLevel LogLevel() const
 		{
 			return m_logLevel;
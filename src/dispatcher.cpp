@@ -0,0 +1,282 @@
+/*
+MIT License
+
+Copyright (c) 2020 Denis Rozhkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// dispatcher.cpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#include <algorithm>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "zubr-core/Logger.hpp"
+
+#include "dispatcher.hpp"
+
+
+using namespace zubr;
+
+
+worker::worker( int cpu,
+	int messagesPerSecond,
+	const std::function<void()> & notify )
+	: m_cpu( cpu )
+	, m_messageBudget( messagesPerSecond )
+	, m_events( 4096 )
+	, m_commands( 1024 )
+	, m_hasOverflow( false )
+	, m_overflowCount( 0 )
+	, m_notify( notify )
+	, m_isRunning( false )
+{
+}
+
+void worker::run()
+{
+	workerEvent ev;
+
+	while ( m_isRunning.load( std::memory_order_relaxed ) ) {
+		bool isIdle = true;
+
+		while ( m_events.Pop( ev ) ) {
+			isIdle = false;
+
+			auto it = m_quoters.find( ev.instrumentId );
+
+			if ( m_quoters.end() != it ) {
+				it->second->OnEvent( ev.event );
+			}
+		}
+
+		// held events are queued by the connector thread once it drains
+		if ( m_hasOverflow.load( std::memory_order_acquire ) ) {
+			m_notify();
+		}
+
+		if ( !m_timers.empty() ) {
+			runTimers();
+		}
+
+		if ( isIdle ) {
+			std::this_thread::yield();
+		}
+	}
+}
+
+void worker::runTimers()
+{
+	auto now = t_clock::now();
+
+	for ( size_t i = 0; i < m_timers.size(); ) {
+		if ( m_timers[i].first <= now ) {
+			// handler may set new timers
+			auto handler = std::move( m_timers[i].second );
+			m_timers[i] = std::move( m_timers.back() );
+			m_timers.pop_back();
+
+			handler();
+		}
+		else {
+			++i;
+		}
+	}
+}
+
+void worker::pushCommand( orderCommand && cmd )
+{
+	while ( !m_commands.Push( std::move( cmd ) ) ) {
+		std::this_thread::yield();
+	}
+
+	m_notify();
+}
+
+void worker::AddQuoter( const confInstrument & conf, BlockPool & orderPool )
+{
+	m_quoters[conf.InstrumentId()].reset(
+		new quoter( conf, *this, m_messageBudget, orderPool ) );
+}
+
+void worker::Post( workerEvent && ev )
+{
+	// events are held in order behind those held already
+	if ( m_overflow.empty() && m_events.Push( std::move( ev ) ) ) {
+		return;
+	}
+
+	if ( m_overflow.empty() ) {
+		m_hasOverflow.store( true, std::memory_order_release );
+
+		ZUBR_LOG_INFO( "worker queue full, events held so far: "
+					   << m_overflowCount );
+	}
+
+	m_overflow.push_back( std::move( ev ) );
+	++m_overflowCount;
+
+	FlushOverflow();
+}
+
+void worker::FlushOverflow()
+{
+	while ( !m_overflow.empty()
+			&& m_events.Push( std::move( m_overflow.front() ) ) ) {
+
+		m_overflow.pop_front();
+	}
+
+	if ( m_overflow.empty() ) {
+		m_hasOverflow.store( false, std::memory_order_release );
+	}
+}
+
+void worker::PlaceOrder( const std::shared_ptr<PlaceOrderRequestWs> & req )
+{
+	pushCommand( orderCommand::Place( req ) );
+}
+
+void worker::CancelOrder( t_order_id orderId )
+{
+	pushCommand( orderCommand::Cancel( orderId ) );
+}
+
+void worker::ResubscribeOrderBook()
+{
+	pushCommand( orderCommand::ResubscribeOrderBook() );
+}
+
+void worker::CancelAll( const char * reason )
+{
+	pushCommand( orderCommand::CancelAll( reason ) );
+}
+
+void worker::SetTimer(
+	long milliseconds, const std::function<void()> & handler )
+{
+
+	m_timers.emplace_back(
+		t_clock::now() + std::chrono::milliseconds( milliseconds ), handler );
+}
+
+void worker::Start()
+{
+	m_isRunning.store( true );
+	m_thread = std::thread( &worker::run, this );
+
+	if ( m_cpu >= 0 ) {
+		cpu_set_t cpus;
+		CPU_ZERO( &cpus );
+		CPU_SET( m_cpu, &cpus );
+
+		if ( 0
+			 != pthread_setaffinity_np(
+				 m_thread.native_handle(), sizeof( cpus ), &cpus ) ) {
+
+			ZUBR_LOG_ERROR( "failed to pin worker to CPU " << m_cpu );
+		}
+	}
+}
+
+void worker::Stop()
+{
+	m_isRunning.store( false );
+
+	if ( m_thread.joinable() ) {
+		m_thread.join();
+	}
+}
+
+
+dispatcher::dispatcher( const conf & conf,
+	BlockPool & orderPool,
+	const std::function<void()> & wakeup )
+	: m_wakeup( wakeup )
+{
+
+	m_isDrainScheduled.clear();
+
+	auto & instruments = conf.Instruments();
+	size_t workerCount = conf.Workers().Count();
+	int messagesPerSecond = conf.QuotePolicy().MessagesPerSecond();
+
+	auto notify = [this]() {
+		if ( !m_isDrainScheduled.test_and_set( std::memory_order_acq_rel ) ) {
+			m_wakeup();
+		}
+	};
+
+	for ( size_t i = 0; i < workerCount; ++i ) {
+		size_t instrumentCount = 0;
+
+		for ( size_t j = i; j < instruments.size(); j += workerCount ) {
+			++instrumentCount;
+		}
+
+		// the connection wide budget is shared in proportion to the
+		// instruments quoted by the worker
+		int budget = 0;
+
+		if ( messagesPerSecond > 0 && !instruments.empty() ) {
+			budget = std::max<int>( 1,
+				messagesPerSecond * instrumentCount / instruments.size() );
+		}
+
+		int cpu = i < conf.Workers().Cpus().size() ? conf.Workers().Cpus()[i]
+												   : -1;
+
+		m_workers.emplace_back( new worker( cpu, budget, notify ) );
+	}
+
+	for ( size_t i = 0; i < instruments.size(); ++i ) {
+		auto & w = m_workers[i % workerCount];
+
+		w->AddQuoter( instruments[i], orderPool );
+		m_routes[instruments[i].InstrumentId()] = w.get();
+	}
+}
+
+void dispatcher::Post( t_instrument_id instrumentId, quoterEvent && ev )
+{
+	auto it = m_routes.find( instrumentId );
+
+	if ( m_routes.end() != it ) {
+		it->second->Post( workerEvent{ instrumentId, std::move( ev ) } );
+	}
+}
+
+void dispatcher::Start()
+{
+	for ( auto & w : m_workers ) {
+		w->Start();
+	}
+}
+
+void dispatcher::Stop()
+{
+	for ( auto & w : m_workers ) {
+		w->Stop();
+	}
+}
@@ -0,0 +1,230 @@
+/*
+MIT License
+
+Copyright (c) 2020 Denis Rozhkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// dispatcher.hpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#ifndef __ZUBROBOT_DISPATCHER__H
+#define __ZUBROBOT_DISPATCHER__H
+
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "zubr-core/SpscQueue.hpp"
+
+#include "conf.hpp"
+#include "quotePolicy.hpp"
+#include "quoter.hpp"
+
+
+namespace zubr {
+
+	struct workerEvent {
+		t_instrument_id instrumentId;
+		quoterEvent event;
+	};
+
+	/// @brief order message to be sent by the connector thread
+	struct orderCommand {
+		/// @brief place order request, cancel of orderId if empty
+		std::shared_ptr<PlaceOrderRequestWs> req;
+		t_order_id orderId = 0;
+		/// @brief order book resubscription, req and orderId are unused
+		bool resubscribeOrderBook = false;
+		/// @brief cancel all with this reason if set, req and orderId are
+		/// unused
+		const char * cancelAllReason = nullptr;
+
+		static orderCommand Place(
+			const std::shared_ptr<PlaceOrderRequestWs> & req )
+		{
+
+			orderCommand cmd;
+			cmd.req = req;
+
+			return cmd;
+		}
+
+		static orderCommand Cancel( t_order_id orderId )
+		{
+			orderCommand cmd;
+			cmd.orderId = orderId;
+
+			return cmd;
+		}
+
+		static orderCommand ResubscribeOrderBook()
+		{
+			orderCommand cmd;
+			cmd.resubscribeOrderBook = true;
+
+			return cmd;
+		}
+
+		static orderCommand CancelAll( const char * reason )
+		{
+			orderCommand cmd;
+			cmd.cancelAllReason = reason;
+
+			return cmd;
+		}
+	};
+
+	/// @brief strategy thread exclusively owning the quoters of its
+	/// instruments
+	class worker : public orderSink {
+	protected:
+		int m_cpu;
+
+		messageBudget m_messageBudget;
+
+		std::unordered_map<t_instrument_id, std::unique_ptr<quoter>>
+			m_quoters;
+
+		SpscQueue<workerEvent> m_events;
+		SpscQueue<orderCommand> m_commands;
+
+		/// @brief events the full queue did not take, connector thread
+		/// only, the connector must not wait for the worker which may
+		/// itself wait for the commands to be drained
+		std::deque<workerEvent> m_overflow;
+		std::atomic<bool> m_hasOverflow;
+		size_t m_overflowCount;
+
+		std::vector<std::pair<t_clock::time_point, std::function<void()>>>
+			m_timers;
+
+		std::function<void()> m_notify;
+
+		std::atomic<bool> m_isRunning;
+		std::thread m_thread;
+
+	protected:
+		void run();
+		void runTimers();
+		void pushCommand( orderCommand && cmd );
+
+	public:
+		/// @brief strategy thread
+		/// @param cpu CPU to pin the thread to, -1 - not pinned
+		/// @param messagesPerSecond message budget of the worker
+		/// @param notify invoked after order commands are queued
+		worker( int cpu,
+			int messagesPerSecond,
+			const std::function<void()> & notify );
+
+		virtual ~worker()
+		{
+			Stop();
+		}
+
+		void AddQuoter( const confInstrument & conf, BlockPool & orderPool );
+
+		/// @brief queue event, never blocks (single producer - connector
+		/// thread)
+		void Post( workerEvent && ev );
+
+		/// @brief move held events to the queue as far as it takes them
+		/// (connector thread)
+		void FlushOverflow();
+
+		/// @brief dequeue order command (single consumer - connector thread)
+		bool PopCommand( orderCommand & cmd )
+		{
+			return m_commands.Pop( cmd );
+		}
+
+		void PlaceOrder(
+			const std::shared_ptr<PlaceOrderRequestWs> & req ) override;
+
+		void CancelOrder( t_order_id orderId ) override;
+
+		void ResubscribeOrderBook() override;
+
+		void CancelAll( const char * reason ) override;
+
+		void SetTimer( long milliseconds,
+			const std::function<void()> & handler ) override;
+
+		void Start();
+		void Stop();
+	};
+
+	/// @brief routes per instrument events to the workers owning the
+	/// instruments
+	class dispatcher {
+	protected:
+		std::vector<std::unique_ptr<worker>> m_workers;
+		std::unordered_map<t_instrument_id, worker *> m_routes;
+
+		std::atomic_flag m_isDrainScheduled;
+		std::function<void()> m_wakeup;
+
+	public:
+		/// @brief routes per instrument events to the workers
+		/// @param conf instruments are assigned to workers round robin
+		/// @param orderPool shared by the quoters of all workers
+		/// @param wakeup invoked (from a worker thread) when order commands
+		/// are to be drained
+		dispatcher( const conf & conf,
+			BlockPool & orderPool,
+			const std::function<void()> & wakeup );
+
+		/// @brief queue event for the worker owning the instrument
+		void Post( t_instrument_id instrumentId, quoterEvent && ev );
+
+		/// @brief dequeue all order commands
+		/// @tparam THandler void( orderCommand & )
+		template <typename THandler> void Drain( const THandler & handler )
+		{
+			m_isDrainScheduled.clear( std::memory_order_release );
+
+			orderCommand cmd;
+
+			for ( auto & w : m_workers ) {
+				w->FlushOverflow();
+
+				while ( w->PopCommand( cmd ) ) {
+					handler( cmd );
+				}
+			}
+		}
+
+		void Start();
+		void Stop();
+	};
+
+} // namespace zubr
+
+
+#endif
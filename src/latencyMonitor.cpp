@@ -0,0 +1,161 @@
+/*
+MIT License
+
+Copyright (c) 2020 Denis Rozhkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// latencyMonitor.cpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#include <algorithm>
+#include <cmath>
+
+#include "latencyMonitor.hpp"
+
+
+using namespace zubr;
+
+
+latencyMonitor::latencyMonitor( const confLatency & conf )
+	: m_conf( conf )
+	, m_nextAck( 0 )
+	, m_loopLagUs( 0 )
+	, m_isTripped( false )
+{
+
+	m_acks.reserve( AckSamples );
+	m_rtts.reserve( AckSamples );
+}
+
+void latencyMonitor::OnAck( t_clock::time_point now, t_clock::duration rtt )
+{
+	ackSample sample{ now,
+		std::chrono::duration_cast<std::chrono::microseconds>( rtt )
+			.count() };
+
+	if ( m_acks.size() < AckSamples ) {
+		m_acks.push_back( sample );
+		return;
+	}
+
+	m_acks[m_nextAck] = sample;
+	m_nextAck = ( m_nextAck + 1 ) % AckSamples;
+}
+
+void latencyMonitor::Reset()
+{
+	m_acks.clear();
+	m_nextAck = 0;
+	m_loopLagUs = 0;
+	m_lastBookAt = t_clock::time_point();
+}
+
+int64_t latencyMonitor::AckRttUs( t_clock::time_point now ) const
+{
+	auto from = now - std::chrono::milliseconds( m_conf.WindowMs() );
+
+	m_rtts.clear();
+
+	for ( auto & sample : m_acks ) {
+		if ( sample.at >= from ) {
+			m_rtts.push_back( sample.rttUs );
+		}
+	}
+
+	if ( m_rtts.size() < MinAckSamples ) {
+		return -1;
+	}
+
+	auto rank = static_cast<size_t>(
+		std::ceil( m_conf.AckRttPercentile() / 100 * m_rtts.size() ) );
+
+	auto it = m_rtts.begin() + std::min( std::max<size_t>( rank, 1 ),
+								   m_rtts.size() )
+			  - 1;
+
+	std::nth_element( m_rtts.begin(), it, m_rtts.end() );
+
+	return *it;
+}
+
+const char * latencyMonitor::findTrigger( t_clock::time_point now ) const
+{
+	if ( m_conf.MaxLoopLagUs() > 0 && m_loopLagUs > m_conf.MaxLoopLagUs() ) {
+		return "event loop lag";
+	}
+
+	if ( m_conf.MaxAckRttUs() > 0
+		 && AckRttUs( now ) > m_conf.MaxAckRttUs() ) {
+
+		return "order ack round trip";
+	}
+
+	// no book yet is a resynchronization, not staleness
+	if ( m_conf.MaxBookAgeMs() > 0 && t_clock::time_point() != m_lastBookAt
+		 && now - m_lastBookAt
+				> std::chrono::milliseconds( m_conf.MaxBookAgeMs() ) ) {
+
+		return "order book age";
+	}
+
+	return nullptr;
+}
+
+latencyMonitor::transition latencyMonitor::Check(
+	t_clock::time_point now, const char *& reason )
+{
+
+	auto trigger = findTrigger( now );
+
+	if ( trigger ) {
+		m_healthySince = t_clock::time_point();
+
+		if ( m_isTripped ) {
+			return transition::None;
+		}
+
+		m_isTripped = true;
+		reason = trigger;
+
+		return transition::Trip;
+	}
+
+	if ( !m_isTripped ) {
+		return transition::None;
+	}
+
+	if ( t_clock::time_point() == m_healthySince ) {
+		m_healthySince = now;
+	}
+
+	if ( now - m_healthySince
+		 < std::chrono::milliseconds( m_conf.RecoveryMs() ) ) {
+
+		return transition::None;
+	}
+
+	m_isTripped = false;
+	m_healthySince = t_clock::time_point();
+
+	return transition::Recover;
+}
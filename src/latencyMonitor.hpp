@@ -0,0 +1,122 @@
+/*
+MIT License
+
+Copyright (c) 2020 Denis Rozhkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// latencyMonitor.hpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#ifndef __ZUBROBOT_LATENCY_MONITOR__H
+#define __ZUBROBOT_LATENCY_MONITOR__H
+
+
+#include <vector>
+
+#include "conf.hpp"
+#include "quotePolicy.hpp"
+
+
+namespace zubr {
+
+	/// @brief connection wide circuit breaker, trips when the event loop,
+	/// the order acknowledgements or the order book fall behind and resets
+	/// once every trigger stays below its threshold for the recovery time
+	class latencyMonitor {
+	public:
+		enum class transition { None, Trip, Recover };
+
+	protected:
+		/// @brief round trips kept, the oldest are overwritten
+		static constexpr size_t AckSamples = 256;
+		/// @brief fewer round trips in the window are not evaluated
+		static constexpr size_t MinAckSamples = 5;
+
+		struct ackSample {
+			t_clock::time_point at;
+			int64_t rttUs;
+		};
+
+		confLatency m_conf;
+
+		std::vector<ackSample> m_acks;
+		size_t m_nextAck;
+		mutable std::vector<int64_t> m_rtts;
+
+		int64_t m_loopLagUs;
+		t_clock::time_point m_lastBookAt;
+
+		bool m_isTripped;
+		t_clock::time_point m_healthySince;
+
+	protected:
+		/// @brief trigger above its threshold, nullptr - none
+		const char * findTrigger( t_clock::time_point now ) const;
+
+	public:
+		latencyMonitor( const confLatency & conf );
+
+		/// @brief account event loop wake latency sample
+		void OnLoopLag( int64_t latencyUs )
+		{
+			m_loopLagUs = latencyUs;
+		}
+
+		/// @brief account place order round trip
+		void OnAck( t_clock::time_point now, t_clock::duration rtt );
+
+		/// @brief account order book message
+		void OnBook( t_clock::time_point now )
+		{
+			m_lastBookAt = now;
+		}
+
+		/// @brief forget samples of a closed connection, the trip state is
+		/// kept
+		void Reset();
+
+		/// @brief evaluate triggers
+		/// @param now
+		/// @param reason set to the trigger on transition::Trip
+		/// @return
+		transition Check( t_clock::time_point now, const char *& reason );
+
+		/// @brief round trip at the configured percentile of the window,
+		/// -1 - too few samples
+		int64_t AckRttUs( t_clock::time_point now ) const;
+
+		int64_t LoopLagUs() const
+		{
+			return m_loopLagUs;
+		}
+
+		bool IsTripped() const
+		{
+			return m_isTripped;
+		}
+	};
+
+} // namespace zubr
+
+
+#endif
@@ -0,0 +1,376 @@
+/*
+MIT License
+
+Copyright (c) 2020 Denis Rozhkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// orderBook.cpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#include <algorithm>
+#include <cmath>
+
+#include "zubr-core/DepthScan.hpp"
+
+#include "orderBook.hpp"
+
+
+using namespace zubr;
+
+
+orderBook::orderBook( int depthTicks, int imbalanceTicks )
+	: m_tickValue( 0 )
+	, m_baseTick( NoTick )
+{
+
+	for ( auto * s : { &m_bids, &m_asks } ) {
+		s->levels.assign( WindowTicks, 0 );
+		s->bestTick = NoTick;
+		s->depth = orderBookBand{ std::max( depthTicks, 1 ), 0, 0 };
+		s->imbalance = orderBookBand{ std::max( imbalanceTicks, 1 ), 0, 0 };
+	}
+
+	m_bids.direction = 1;
+	m_asks.direction = -1;
+}
+
+bool orderBook::TickSize( const Number & tickSize )
+{
+	if ( m_tickSize.HasValue() && !( m_tickSize < tickSize )
+		 && !( tickSize < m_tickSize ) ) {
+
+		return false;
+	}
+
+	m_tickSize = tickSize;
+	m_tickValue = tickSize.Value();
+	Clear();
+
+	return true;
+}
+
+int64_t orderBook::tick( const Number & price ) const
+{
+	return std::llround( price.Value() / m_tickValue );
+}
+
+Number orderBook::price( int64_t tick ) const
+{
+	Number result = m_tickSize;
+
+	return result.Mul( tick );
+}
+
+void orderBook::addRange(
+	const side & s, orderBookBand & band, int64_t from, int64_t to, int sign )
+{
+
+	from = std::max( from, m_baseTick );
+	to = std::min( to, m_baseTick + WindowTicks - 1 );
+
+	if ( from > to ) {
+		return;
+	}
+
+	// first tick at the lowest index, ticks step by -direction
+	auto firstTick = ( s.direction > 0 ? to : from );
+	auto first = index( s, firstTick );
+
+	int64_t quantity;
+	int64_t indexQuantity;
+	DepthScan::WeightedSum(
+		&s.levels[first], to - from + 1, quantity, indexQuantity );
+
+	band.quantity += sign * quantity;
+	band.tickQuantity
+		+= sign * ( quantity * firstTick - s.direction * indexQuantity );
+}
+
+void orderBook::shiftBand(
+	side & s, orderBookBand & band, int64_t fromTick, int64_t toTick )
+{
+
+	if ( NoTick == fromTick || NoTick == toTick
+		 || std::abs( toTick - fromTick ) >= band.width ) {
+
+		band.quantity = 0;
+		band.tickQuantity = 0;
+
+		if ( NoTick != toTick ) {
+			addRange( s,
+				band,
+				std::min( toTick, toTick - s.direction * ( band.width - 1 ) ),
+				std::max( toTick, toTick - s.direction * ( band.width - 1 ) ),
+				1 );
+		}
+
+		return;
+	}
+
+	// bands as [lo, hi] tick ranges of the same width
+	auto lo = [&s, &band]( int64_t best ) {
+		return ( s.direction > 0 ? best - band.width + 1 : best );
+	};
+
+	auto fromLo = lo( fromTick );
+	auto toLo = lo( toTick );
+	auto fromHi = fromLo + band.width - 1;
+	auto toHi = toLo + band.width - 1;
+
+	if ( toLo > fromLo ) {
+		addRange( s, band, fromLo, toLo - 1, -1 );
+		addRange( s, band, fromHi + 1, toHi, 1 );
+	}
+	else {
+		addRange( s, band, toHi + 1, fromHi, -1 );
+		addRange( s, band, toLo, fromLo - 1, 1 );
+	}
+}
+
+void orderBook::moveBest( side & s, int64_t tick )
+{
+	if ( tick == s.bestTick ) {
+		return;
+	}
+
+	shiftBand( s, s.depth, s.bestTick, tick );
+	shiftBand( s, s.imbalance, s.bestTick, tick );
+	s.bestTick = tick;
+}
+
+int64_t orderBook::findBest( const side & s, int64_t tick ) const
+{
+	size_t first = index( s, tick ) + 1;
+	size_t n = WindowTicks - first;
+
+	// quantities are not negative, the first running sum reaching one is
+	// the first non empty level
+	int64_t sum;
+	auto i = DepthScan::FindCumulative( s.levels.data() + first, n, 1, sum );
+
+	return ( i < n ? tick - s.direction * static_cast<int64_t>( i + 1 )
+				   : NoTick );
+}
+
+void orderBook::setLevel( side & s, int64_t tick, int64_t quantity )
+{
+	if ( NoTick == m_baseTick ) {
+		m_baseTick = tick - WindowTicks / 2;
+	}
+	else if ( !isInWindow( tick ) ) {
+		recenter();
+
+		// far from the touch
+		if ( !isInWindow( tick ) ) {
+			return;
+		}
+	}
+
+	auto & level = s.levels[index( s, tick )];
+	auto delta = quantity - level;
+	level = quantity;
+
+	if ( NoTick != s.bestTick ) {
+		for ( auto * band : { &s.depth, &s.imbalance } ) {
+			if ( isInBand( s, *band, tick ) ) {
+				band->quantity += delta;
+				band->tickQuantity += delta * tick;
+			}
+		}
+	}
+
+	if ( quantity > 0 ) {
+		if ( NoTick == s.bestTick
+			 || s.direction * ( tick - s.bestTick ) > 0 ) {
+
+			moveBest( s, tick );
+		}
+	}
+	else if ( tick == s.bestTick ) {
+		moveBest( s, findBest( s, tick ) );
+	}
+}
+
+void orderBook::recenter()
+{
+	int64_t center;
+
+	if ( HasBid() && HasAsk() ) {
+		center = ( m_bids.bestTick + m_asks.bestTick ) / 2;
+	}
+	else if ( HasBid() || HasAsk() ) {
+		center = ( HasBid() ? m_bids.bestTick : m_asks.bestTick );
+	}
+	else {
+		return;
+	}
+
+	auto baseTick = center - WindowTicks / 2;
+	auto shift = baseTick - m_baseTick;
+
+	// not drifted enough to be worth the copy
+	if ( std::abs( shift ) < WindowTicks / 4 ) {
+		return;
+	}
+
+	for ( auto * s : { &m_bids, &m_asks } ) {
+		std::vector<int64_t> levels( WindowTicks, 0 );
+
+		for ( int64_t i = 0; i < WindowTicks; ++i ) {
+			auto j = i - s->direction * shift;
+
+			if ( j >= 0 && j < WindowTicks ) {
+				levels[i] = s->levels[j];
+			}
+		}
+
+		s->levels.swap( levels );
+	}
+
+	m_baseTick = baseTick;
+
+	// levels out of the new window are gone
+	for ( auto * s : { &m_bids, &m_asks } ) {
+		shiftBand( *s, s->depth, NoTick, s->bestTick );
+		shiftBand( *s, s->imbalance, NoTick, s->bestTick );
+	}
+}
+
+void orderBook::clearSide( side & s )
+{
+	std::fill( s.levels.begin(), s.levels.end(), 0 );
+	s.bestTick = NoTick;
+	s.depth.quantity = s.depth.tickQuantity = 0;
+	s.imbalance.quantity = s.imbalance.tickQuantity = 0;
+}
+
+void orderBook::Clear()
+{
+	clearSide( m_bids );
+	clearSide( m_asks );
+	m_baseTick = NoTick;
+}
+
+void orderBook::Apply( const OrderBookEntry & entry )
+{
+	if ( entry.IsSnapshot() ) {
+		Clear();
+
+		// center the window on the touch of the snapshot
+		int64_t bestBid = NoTick;
+		int64_t bestAsk = INT64_MAX;
+
+		for ( auto & item : entry.Bids() ) {
+			if ( item.Quantity() > 0 ) {
+				bestBid = std::max( bestBid, tick( item.Price() ) );
+			}
+		}
+
+		for ( auto & item : entry.Asks() ) {
+			if ( item.Quantity() > 0 ) {
+				bestAsk = std::min( bestAsk, tick( item.Price() ) );
+			}
+		}
+
+		if ( NoTick != bestBid && INT64_MAX != bestAsk ) {
+			m_baseTick = ( bestBid + bestAsk ) / 2 - WindowTicks / 2;
+		}
+	}
+
+	for ( auto & item : entry.Bids() ) {
+		setLevel( m_bids, tick( item.Price() ), item.Quantity() );
+	}
+
+	for ( auto & item : entry.Asks() ) {
+		setLevel( m_asks, tick( item.Price() ), item.Quantity() );
+	}
+}
+
+double orderBook::Microprice() const
+{
+	auto bidQuantity = level( m_bids, m_bids.bestTick );
+	auto askQuantity = level( m_asks, m_asks.bestTick );
+
+	return ( static_cast<double>( m_bids.bestTick ) * askQuantity
+			   + static_cast<double>( m_asks.bestTick ) * bidQuantity )
+		   / ( bidQuantity + askQuantity ) * m_tickValue;
+}
+
+double orderBook::Imbalance() const
+{
+	auto bidQuantity = m_bids.imbalance.quantity;
+	auto askQuantity = m_asks.imbalance.quantity;
+
+	return ( bidQuantity + askQuantity > 0
+				 ? static_cast<double>( bidQuantity - askQuantity )
+					   / ( bidQuantity + askQuantity )
+				 : 0 );
+}
+
+double orderBook::DepthWeightedMid() const
+{
+	auto & bid = m_bids.depth;
+	auto & ask = m_asks.depth;
+
+	return ( bandTick( bid ) * ask.quantity + bandTick( ask ) * bid.quantity )
+		   / ( bid.quantity + ask.quantity ) * m_tickValue;
+}
+
+bool orderBook::Sweep( OrderDirection direction,
+	int64_t quantity,
+	double & vwap,
+	double & worst ) const
+{
+
+	auto & s = ( OrderDirection::Buy == direction ? m_asks : m_bids );
+
+	if ( NoTick == s.bestTick || quantity <= 0 ) {
+		return false;
+	}
+
+	size_t first = index( s, s.bestTick );
+	size_t n = WindowTicks - first;
+	auto levels = s.levels.data() + first;
+
+	int64_t sum;
+	auto last = DepthScan::FindCumulative( levels, n, quantity, sum );
+
+	if ( last == n ) {
+		return false;
+	}
+
+	int64_t taken;
+	int64_t indexQuantity;
+	DepthScan::WeightedSum( levels, last + 1, taken, indexQuantity );
+
+	auto lastTick = s.bestTick - s.direction * static_cast<int64_t>( last );
+
+	// the last level is taken partially
+	auto tickQuantity = taken * s.bestTick - s.direction * indexQuantity
+						- ( sum - quantity ) * lastTick;
+
+	vwap = static_cast<double>( tickQuantity ) / quantity * m_tickValue;
+	worst = lastTick * m_tickValue;
+
+	return true;
+}
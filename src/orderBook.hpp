@@ -0,0 +1,243 @@
+/*
+MIT License
+
+Copyright (c) 2020 Denis Rozhkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// orderBook.hpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#ifndef __ZUBROBOT_ORDER_BOOK__H
+#define __ZUBROBOT_ORDER_BOOK__H
+
+
+#include <climits>
+#include <cstdint>
+#include <vector>
+
+#include "zubr-core/Types.hpp"
+
+
+namespace zubr {
+
+	/// @brief levels of one side within a band of ticks from the best price
+	struct orderBookBand {
+		int width;
+		int64_t quantity;
+		/// @brief sum of tick * quantity, for the volume weighted price
+		int64_t tickQuantity;
+	};
+
+	/// @brief order book of a single instrument, levels are indexed by tick
+	/// within a window around the touch, analytics are kept up to date on
+	/// every level change
+	///
+	/// bids are stored in reverse tick order, so on both sides levels away
+	/// from the touch are at higher indexes and scanned by DepthScan
+	class orderBook {
+	public:
+		static constexpr int WindowTicks = 8192;
+		static constexpr int64_t NoTick = INT64_MIN;
+
+	protected:
+		struct side {
+			/// @brief quantity by index( tick )
+			std::vector<int64_t> levels;
+			int64_t bestTick;
+			/// @brief 1 - bids (higher is better), -1 - asks
+			int direction;
+
+			orderBookBand depth;
+			orderBookBand imbalance;
+		};
+
+	protected:
+		Number m_tickSize;
+		double m_tickValue;
+
+		/// @brief tick of levels[0], NoTick until the first level
+		int64_t m_baseTick;
+
+		side m_bids;
+		side m_asks;
+
+	protected:
+		bool isInWindow( int64_t tick ) const
+		{
+			return ( tick >= m_baseTick && tick - m_baseTick < WindowTicks );
+		}
+
+		int64_t index( const side & s, int64_t tick ) const
+		{
+			return ( s.direction > 0 ? m_baseTick + WindowTicks - 1 - tick
+									 : tick - m_baseTick );
+		}
+
+		int64_t level( const side & s, int64_t tick ) const
+		{
+			return ( isInWindow( tick ) ? s.levels[index( s, tick )] : 0 );
+		}
+
+		static bool isInBand(
+			const side & s, const orderBookBand & band, int64_t tick )
+		{
+			auto distance = s.direction * ( s.bestTick - tick );
+
+			return ( distance >= 0 && distance < band.width );
+		}
+
+		/// @brief add (sign 1) or remove (-1) levels of ticks [from, to]
+		void addRange( const side & s,
+			orderBookBand & band,
+			int64_t from,
+			int64_t to,
+			int sign );
+
+		/// @brief follow the best price move with the band, O(move)
+		void shiftBand( side & s,
+			orderBookBand & band,
+			int64_t fromTick,
+			int64_t toTick );
+
+		void moveBest( side & s, int64_t tick );
+
+		/// @brief next level worse than tick, NoTick if none in the window
+		int64_t findBest( const side & s, int64_t tick ) const;
+
+		void setLevel( side & s, int64_t tick, int64_t quantity );
+
+		/// @brief move the window to be centered on the touch
+		void recenter();
+
+		void clearSide( side & s );
+
+		int64_t tick( const Number & price ) const;
+
+		Number price( int64_t tick ) const;
+
+		/// @brief volume weighted tick of the band
+		static double bandTick( const orderBookBand & band )
+		{
+			return static_cast<double>( band.tickQuantity ) / band.quantity;
+		}
+
+	public:
+		/// @brief order book of a single instrument
+		/// @param depthTicks band of the depth weighted mid and cumulative
+		/// depth
+		/// @param imbalanceTicks band of the imbalance
+		orderBook( int depthTicks, int imbalanceTicks );
+
+		/// @brief set price increment, levels are dropped on change
+		/// @return true if the increment has changed
+		bool TickSize( const Number & tickSize );
+
+		bool HasTickSize() const
+		{
+			return m_tickSize.HasValue();
+		}
+
+		/// @brief replace (snapshot) or update levels
+		void Apply( const OrderBookEntry & entry );
+
+		void Clear();
+
+		bool HasBid() const
+		{
+			return ( NoTick != m_bids.bestTick );
+		}
+
+		bool HasAsk() const
+		{
+			return ( NoTick != m_asks.bestTick );
+		}
+
+		/// @brief best bid and ask are present and not crossed
+		bool IsValid() const
+		{
+			return ( HasBid() && HasAsk() && m_bids.bestTick < m_asks.bestTick );
+		}
+
+		bool IsCrossed() const
+		{
+			return ( HasBid() && HasAsk() && m_bids.bestTick >= m_asks.bestTick );
+		}
+
+		/// @brief best bid price, no value if the side is empty
+		Number BestBid() const
+		{
+			return ( HasBid() ? price( m_bids.bestTick ) : Number() );
+		}
+
+		/// @brief best ask price, no value if the side is empty
+		Number BestAsk() const
+		{
+			return ( HasAsk() ? price( m_asks.bestTick ) : Number() );
+		}
+
+		// analytics below require IsValid()
+
+		double Mid() const
+		{
+			return ( m_bids.bestTick + m_asks.bestTick ) * m_tickValue / 2;
+		}
+
+		/// @brief mid weighted by the opposite best level quantity
+		double Microprice() const;
+
+		/// @brief (bid - ask) / (bid + ask) quantity within the imbalance
+		/// band, -1 .. 1
+		double Imbalance() const;
+
+		/// @brief volume weighted prices of both depth bands, weighted by
+		/// the opposite band quantity
+		double DepthWeightedMid() const;
+
+		/// @brief cumulative bid quantity within the depth band
+		int64_t BidDepth() const
+		{
+			return m_bids.depth.quantity;
+		}
+
+		/// @brief cumulative ask quantity within the depth band
+		int64_t AskDepth() const
+		{
+			return m_asks.depth.quantity;
+		}
+
+		/// @brief fill of a hypothetical market order against the book
+		/// @param direction of the order, buy takes asks
+		/// @param quantity
+		/// @param vwap average fill price
+		/// @param worst price of the last level taken
+		/// @return false if the window holds less than quantity
+		bool Sweep( OrderDirection direction,
+			int64_t quantity,
+			double & vwap,
+			double & worst ) const;
+	};
+
+} // namespace zubr
+
+
+#endif
@@ -0,0 +1,79 @@
+/*
+MIT License
+
+Copyright (c) 2020 Denis Rozhkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// positionLedger.cpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "positionLedger.hpp"
+
+
+using namespace zubr;
+
+
+int positionLedger::OnFill( int position,
+	OrderDirection direction,
+	int quantity,
+	double price,
+	double fee )
+{
+
+	if ( quantity <= 0 ) {
+		return position;
+	}
+
+	int delta = ( OrderDirection::Buy == direction ? quantity : -quantity );
+	int result = position + delta;
+
+	++m_fillCount;
+	m_fees += fee;
+
+	// increased (or opened) position, the entry is averaged
+	if ( 0 == position || ( position > 0 ) == ( delta > 0 ) ) {
+		m_entryPrice
+			= ( m_entryPrice * std::abs( position ) + price * quantity )
+			/ std::abs( result );
+
+		return result;
+	}
+
+	// reduced position, the closed part is realized at the entry price
+	int closed = std::min( std::abs( position ), quantity );
+	m_realizedPnl
+		+= ( price - m_entryPrice ) * ( position > 0 ? closed : -closed );
+
+	if ( 0 == result ) {
+		m_entryPrice = 0;
+	}
+	else if ( ( result > 0 ) != ( position > 0 ) ) {
+		// reversed, the rest opens a position at the fill price
+		m_entryPrice = price;
+	}
+
+	return result;
+}
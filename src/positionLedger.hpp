@@ -0,0 +1,117 @@
+/*
+MIT License
+
+Copyright (c) 2020 Denis Rozhkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// positionLedger.hpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#ifndef __ZUBROBOT_POSITION_LEDGER__H
+#define __ZUBROBOT_POSITION_LEDGER__H
+
+
+#include <cstdint>
+
+#include "zubr-core/Types.hpp"
+
+
+namespace zubr {
+
+	/// @brief average entry price and realized PnL of a single instrument
+	/// position, updated from own fills; the position size itself is owned
+	/// by the caller and passed in, so the ledger never disagrees with it
+	class positionLedger {
+	protected:
+		/// @brief average price of the open position, 0 - flat or unknown
+		double m_entryPrice;
+		/// @brief price difference times quantity, fees excluded
+		double m_realizedPnl;
+		double m_fees;
+		int64_t m_fillCount;
+
+	public:
+		positionLedger()
+			: m_entryPrice( 0 )
+			, m_realizedPnl( 0 )
+			, m_fees( 0 )
+			, m_fillCount( 0 )
+		{
+		}
+
+		/// @brief account fill
+		/// @param position size before the fill
+		/// @param direction
+		/// @param quantity
+		/// @param price
+		/// @param fee
+		/// @return position size after the fill
+		int OnFill( int position,
+			OrderDirection direction,
+			int quantity,
+			double price,
+			double fee );
+
+		/// @brief set entry price of a position taken from the exchange
+		/// @param price
+		void EntryPrice( double price )
+		{
+			m_entryPrice = price;
+		}
+
+		double EntryPrice() const
+		{
+			return m_entryPrice;
+		}
+
+		double RealizedPnl() const
+		{
+			return m_realizedPnl;
+		}
+
+		double Fees() const
+		{
+			return m_fees;
+		}
+
+		int64_t FillCount() const
+		{
+			return m_fillCount;
+		}
+
+		/// @brief PnL of the open position at the mark price
+		/// @param position
+		/// @param markPrice
+		/// @return
+		double UnrealizedPnl( int position, double markPrice ) const
+		{
+			return ( 0 == position || 0 == m_entryPrice
+						 ? 0
+						 : ( markPrice - m_entryPrice ) * position );
+		}
+	};
+
+} // namespace zubr
+
+
+#endif
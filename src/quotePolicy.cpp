@@ -0,0 +1,150 @@
+/*
+MIT License
+
+Copyright (c) 2020 Denis Rozhkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// quotePolicy.cpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#include <cmath>
+
+#include "quotePolicy.hpp"
+
+
+using namespace zubr;
+
+
+messageBudget::messageBudget( int messagesPerSecond )
+	: m_sent( messagesPerSecond > 0 ? messagesPerSecond : 0,
+		  t_clock::time_point::min() )
+	, m_next( 0 )
+{
+}
+
+bool messageBudget::IsAvailable(
+	t_clock::time_point now, int count, t_clock::time_point & retryAt ) const
+{
+	if ( m_sent.empty() ) {
+		return true;
+	}
+
+	if ( static_cast<size_t>( count ) > m_sent.size() ) {
+		count = m_sent.size();
+	}
+
+	// m_sent is ordered by time starting at m_next, so the youngest
+	// of the count slots to be reused decides
+	auto & slot = m_sent[( m_next + count - 1 ) % m_sent.size()];
+
+	if ( slot <= now - std::chrono::seconds( 1 ) ) {
+		return true;
+	}
+
+	retryAt = slot + std::chrono::seconds( 1 );
+
+	return false;
+}
+
+void messageBudget::Consume( t_clock::time_point now, int count )
+{
+	if ( m_sent.empty() ) {
+		return;
+	}
+
+	for ( int i = 0; i < count; ++i ) {
+		m_sent[m_next] = now;
+		m_next = ( m_next + 1 ) % m_sent.size();
+	}
+}
+
+
+quotePolicy::quotePolicy( const confQuotePolicy & conf, messageBudget & budget )
+	: m_conf( conf )
+	, m_budget( budget )
+	, m_lastRequote{ t_clock::time_point::min(), t_clock::time_point::min() }
+	, m_isDeferred{ false, false }
+{
+}
+
+quotePolicy::decision quotePolicy::Check( OrderDirection direction,
+	const Number & current,
+	const Number & target,
+	const Number & minPriceIncrement,
+	t_clock::time_point now,
+	t_clock::time_point & retryAt ) const
+{
+	auto ticks = std::round( std::abs( target.Value() - current.Value() )
+							 / minPriceIncrement.Value() );
+
+	if ( ticks < 1 || ticks < m_conf.MinTickDistance() ) {
+		return decision::Hold;
+	}
+
+	if ( m_conf.MinRequoteIntervalMs() > 0 ) {
+		auto allowedAt = m_lastRequote[sideIndex( direction )]
+						 + std::chrono::milliseconds(
+							 m_conf.MinRequoteIntervalMs() );
+
+		if ( now < allowedAt ) {
+			retryAt = allowedAt;
+			return decision::Defer;
+		}
+	}
+
+	// cancel + place again
+	if ( !m_budget.IsAvailable( now, 2, retryAt ) ) {
+		return decision::Defer;
+	}
+
+	return decision::Requote;
+}
+
+void quotePolicy::OnRequote( OrderDirection direction, t_clock::time_point now )
+{
+	m_lastRequote[sideIndex( direction )] = now;
+	m_budget.Consume( now, 1 );
+}
+
+void quotePolicy::OnMessage( t_clock::time_point now )
+{
+	m_budget.Consume( now, 1 );
+}
+
+bool quotePolicy::Defer( OrderDirection direction )
+{
+	bool & isDeferred = m_isDeferred[sideIndex( direction )];
+
+	if ( isDeferred ) {
+		return false;
+	}
+
+	isDeferred = true;
+
+	return true;
+}
+
+void quotePolicy::Resume( OrderDirection direction )
+{
+	m_isDeferred[sideIndex( direction )] = false;
+}
@@ -0,0 +1,148 @@
+/*
+MIT License
+
+Copyright (c) 2020 Denis Rozhkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// quotePolicy.hpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#ifndef __ZUBROBOT_QUOTE_POLICY__H
+#define __ZUBROBOT_QUOTE_POLICY__H
+
+
+#include <chrono>
+#include <vector>
+
+#include "zubr-core/Types.hpp"
+
+#include "conf.hpp"
+
+
+namespace zubr {
+
+	typedef std::chrono::steady_clock t_clock;
+
+
+	/// @brief rolling one-second outbound message budget
+	class messageBudget {
+	protected:
+		std::vector<t_clock::time_point> m_sent;
+		size_t m_next;
+
+	public:
+		/// @brief rolling one-second outbound message budget
+		/// @param messagesPerSecond budget size, 0 - unlimited
+		messageBudget( int messagesPerSecond );
+
+		/// @brief check whether count messages may be sent now
+		/// @param now
+		/// @param count
+		/// @param retryAt earliest time the messages fit into the budget
+		/// @return
+		bool IsAvailable(
+			t_clock::time_point now, int count, t_clock::time_point & retryAt )
+			const;
+
+		/// @brief account count sent messages
+		void Consume( t_clock::time_point now, int count );
+	};
+
+	/// @brief decides whether a resting quote should be requoted now, later
+	/// or not at all
+	class quotePolicy {
+	public:
+		enum class decision { Requote, Hold, Defer };
+
+	protected:
+		confQuotePolicy m_conf;
+		messageBudget & m_budget;
+
+		t_clock::time_point m_lastRequote[2];
+		bool m_isDeferred[2];
+
+	protected:
+		static size_t sideIndex( OrderDirection direction )
+		{
+			return ( OrderDirection::Buy == direction ? 0 : 1 );
+		}
+
+	public:
+		quotePolicy( const confQuotePolicy & conf, messageBudget & budget );
+
+		/// @brief check requote of a resting order
+		/// @param direction order side
+		/// @param current resting order price
+		/// @param target newly calculated price
+		/// @param minPriceIncrement instrument tick size
+		/// @param now
+		/// @param retryAt set when decision::Defer is returned
+		/// @return
+		decision Check( OrderDirection direction,
+			const Number & current,
+			const Number & target,
+			const Number & minPriceIncrement,
+			t_clock::time_point now,
+			t_clock::time_point & retryAt ) const;
+
+		/// @brief account requote of the side (the cancel message, the
+		/// following placement is accounted by OnMessage)
+		void OnRequote( OrderDirection direction, t_clock::time_point now );
+
+		/// @brief account order placement
+		void OnMessage( t_clock::time_point now );
+
+		/// @brief check whether a burst of count messages fits the budget
+		bool IsBurstAvailable( t_clock::time_point now,
+			int count,
+			t_clock::time_point & retryAt ) const
+		{
+
+			return m_budget.IsAvailable( now, count, retryAt );
+		}
+
+		/// @brief account a burst of count messages
+		void OnBurst( t_clock::time_point now, int count )
+		{
+			m_budget.Consume( now, count );
+		}
+
+		/// @brief account requote of the side without a message of its own
+		/// (ladder shift, the messages are accounted by OnBurst)
+		void OnShift( OrderDirection direction, t_clock::time_point now )
+		{
+			m_lastRequote[sideIndex( direction )] = now;
+		}
+
+		/// @brief mark side as having a deferred requote
+		/// @return false if a requote of the side is already deferred
+		bool Defer( OrderDirection direction );
+
+		/// @brief clear deferred requote mark of the side
+		void Resume( OrderDirection direction );
+	};
+
+} // namespace zubr
+
+
+#endif
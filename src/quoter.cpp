@@ -0,0 +1,1055 @@
+/*
+MIT License
+
+Copyright (c) 2020 Denis Rozhkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// quoter.cpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#include <algorithm>
+#include <cmath>
+
+#include "zubr-core/Logger.hpp"
+
+#include "quoter.hpp"
+
+
+using namespace zubr;
+
+
+double quoter::referencePrice() const
+{
+	auto & pricing = m_conf.Pricing();
+	double price;
+
+	switch ( pricing.Reference() ) {
+		case priceReference::Microprice:
+			price = m_orderBook.Microprice();
+			break;
+
+		case priceReference::DepthWeightedMid:
+			price = m_orderBook.DepthWeightedMid();
+			break;
+
+		default:
+			price = m_orderBook.Mid();
+			break;
+	}
+
+	return price + pricing.ImbalanceSkew() * m_orderBook.Imbalance();
+}
+
+double quoter::interest( double price )
+{
+	auto & tape = m_conf.Tape();
+
+	if ( 0 == tape.VolatilityFactor() ) {
+		return m_conf.Interest();
+	}
+
+	m_tape.Expire( t_clock::now() );
+
+	double result = m_conf.Interest()
+		+ tape.VolatilityFactor() * m_tape.Volatility() * price;
+
+	if ( tape.MaxInterest() > 0 ) {
+		result = std::min( result, tape.MaxInterest() );
+	}
+
+	return result;
+}
+
+Number quoter::calculateOrderPrice( OrderDirection direction )
+{
+	zubr::Number price = m_bestBuyPrice;
+	price.Add( m_bestSellPrice ).Div( 2 );
+
+	// keeps the exponent of the book prices
+	if ( priceReference::Mid != m_conf.Pricing().Reference()
+		 || 0 != m_conf.Pricing().ImbalanceSkew() ) {
+
+		price.Add( referencePrice() - price.Value() );
+	}
+
+	// BUY price = (current best purchase price + current best sale
+	// price) / 2 -
+	//	interest - shift * position;
+	// SELL price = (current best purchase price +
+	//	current best sale price) / 2 + interest - shift * position.
+	double orderInterest = interest( price.Value() );
+
+	if ( OrderDirection::Buy == direction ) {
+		price.Sub( orderInterest );
+	}
+	else {
+		price.Add( orderInterest );
+	}
+
+	price.Sub( m_conf.Shift() * m_positionSize ).ModRing( m_minPriceIncrement );
+
+	return price;
+}
+
+std::shared_ptr<PlaceOrderRequestWs> quoter::newOrder(
+	const Number & price, OrderDirection direction, int quantity )
+{
+
+	return std::allocate_shared<PlaceOrderRequestWs>(
+		PoolAllocator<PlaceOrderRequestWs>( m_orderPool ),
+		m_conf.InstrumentId(),
+		price,
+		direction,
+		quantity,
+		zubr::OrderType::Limit,
+		zubr::OrderLifetime::Gtc );
+}
+
+void quoter::placeOrder(
+	OrderDirection direction, int quantity, bool & isPlaced )
+{
+	zubr::Number price = calculateOrderPrice( direction );
+
+	ZUBR_LOG_INFO( "[" << m_conf.InstrumentId() << "] placing "
+					   << OrderEnumHelper::ToString( direction )
+					   << " order, price: " << price.Value() );
+
+	auto req = newOrder( price, direction, quantity );
+
+	auto now = t_clock::now();
+
+	if ( !submitOrder( req, now ) ) {
+		isPlaced = false;
+
+		return;
+	}
+
+	m_quotePolicy.OnMessage( now );
+
+	isPlaced = true;
+}
+
+bool quoter::submitOrder(
+	const std::shared_ptr<PlaceOrderRequestWs> & req, t_clock::time_point now )
+{
+
+	const char * reason = nullptr;
+	auto quantity = m_riskGate.Check( *req,
+		m_positionSize,
+		m_orderBook.IsValid() ? m_orderBook.Mid() : 0,
+		now,
+		reason );
+
+	if ( 0 == quantity ) {
+		ZUBR_LOG_ERROR( "[" << m_conf.InstrumentId() << "] "
+							<< OrderEnumHelper::ToString( req->Direction() )
+							<< " order rejected by risk gate: " << reason );
+
+		return false;
+	}
+
+	if ( quantity < req->Quantity() ) {
+		ZUBR_LOG_INFO( "[" << m_conf.InstrumentId() << "] "
+						   << OrderEnumHelper::ToString( req->Direction() )
+						   << " order clipped to " << quantity << ": "
+						   << reason );
+
+		req->Quantity( quantity );
+	}
+
+	m_riskGate.OnPlace( req->Direction(), quantity, now );
+	m_sink.PlaceOrder( req );
+
+	return true;
+}
+
+void quoter::cancelOrder( t_order_id orderId )
+{
+	m_riskGate.OnMessage( t_clock::now() );
+	m_sink.CancelOrder( orderId );
+}
+
+void quoter::syncRiskGate()
+{
+	int64_t openQuantity[2] = { 0, 0 };
+
+	for ( auto & itOrder : m_buyOrdersMap ) {
+		openQuantity[0] += itOrder.second.quantity;
+	}
+
+	for ( auto & itOrder : m_sellOrdersMap ) {
+		openQuantity[1] += itOrder.second.quantity;
+	}
+
+	for ( auto & req : m_ladderPending ) {
+		openQuantity[OrderDirection::Buy == req->Direction() ? 0 : 1]
+			+= req->Quantity();
+	}
+
+	m_riskGate.Reset( m_buyOrdersMap.size() + m_sellOrdersMap.size()
+			+ m_ladderPending.size(),
+		openQuantity[0],
+		openQuantity[1] );
+}
+
+void quoter::replaceOrderIfPriceChanged( OrderDirection direction )
+{
+	orderTable & ordersMap
+		= OrderDirection::Buy == direction ? m_buyOrdersMap : m_sellOrdersMap;
+
+	if ( !ordersMap.empty() ) {
+		auto price = calculateOrderPrice( direction );
+		auto now = t_clock::now();
+
+		for ( auto & itOrder : ordersMap ) {
+			// cancel is already sent, the order will be placed again
+			// at the then actual price
+			if ( itOrder.second.isCancelSent ) {
+				continue;
+			}
+
+			t_clock::time_point retryAt;
+
+			switch ( m_quotePolicy.Check( direction,
+				itOrder.second.Price(),
+				price,
+				m_minPriceIncrement,
+				now,
+				retryAt ) ) {
+
+				case quotePolicy::decision::Requote:
+					ZUBR_LOG_INFO( "[" << m_conf.InstrumentId()
+									   << "] replacing order... old price: "
+									   << itOrder.second.Price().Value()
+									   << ", new price: " << price.Value() );
+
+					cancelOrder( itOrder.first );
+					m_quotePolicy.OnRequote( direction, now );
+
+					itOrder.second.Price( price );
+					itOrder.second.isCancelSent = true;
+
+					break;
+
+				case quotePolicy::decision::Defer:
+					deferRequote( direction, retryAt - now );
+
+					break;
+
+				default:
+					break;
+			}
+		}
+	}
+}
+
+void quoter::deferRequote( OrderDirection direction, t_clock::duration delay )
+{
+	if ( !m_quotePolicy.Defer( direction ) ) {
+		return;
+	}
+
+	ZUBR_LOG_DEBUG( "[" << m_conf.InstrumentId() << "] "
+						<< OrderEnumHelper::ToString( direction )
+						<< " requote deferred" );
+
+	m_sink.SetTimer(
+		std::chrono::duration_cast<std::chrono::milliseconds>( delay ).count()
+			+ 1,
+		[this, direction]() {
+			m_quotePolicy.Resume( direction );
+
+			if ( IsSynced() && !m_isSuspended ) {
+				replaceOrderIfPriceChanged( direction );
+			}
+		} );
+}
+
+void quoter::onOrderBook( const OrderBookEntry & entry )
+{
+	// levels are indexed by tick
+	if ( !m_orderBook.HasTickSize() ) {
+		m_isBookDeferred = true;
+		return;
+	}
+
+	if ( entry.IsSnapshot() ) {
+		m_hasBookSnapshot = true;
+		m_isBookResubscribeRequested = false;
+	}
+	else if ( !m_hasBookSnapshot ) {
+		// levels of the delta are relative to a book never received
+		invalidateBook( "delta before snapshot" );
+		return;
+	}
+
+	m_orderBook.Apply( entry );
+
+	if ( m_orderBook.IsCrossed() ) {
+		invalidateBook( "crossed book" );
+		return;
+	}
+
+	m_bestBuyPrice = m_orderBook.BestBid();
+	m_bestSellPrice = m_orderBook.BestAsk();
+
+	ZUBR_LOG_INFO( "[" << m_conf.InstrumentId() << "] best BUY price: "
+					   << m_bestBuyPrice.Value() << "\tbest SELL price: "
+					   << m_bestSellPrice.Value() );
+
+	if ( m_orderBook.IsValid() ) {
+		ZUBR_LOG_DEBUG( "[" << m_conf.InstrumentId()
+							<< "] microprice: " << m_orderBook.Microprice()
+							<< ", imbalance: " << m_orderBook.Imbalance()
+							<< ", depth weighted mid: "
+							<< m_orderBook.DepthWeightedMid()
+							<< ", depth: " << m_orderBook.BidDepth() << "/"
+							<< m_orderBook.AskDepth() );
+
+		double buyVwap;
+		double sellVwap;
+		double worst;
+
+		// cost of taking the quote quantity
+		if ( m_orderBook.Sweep(
+				 OrderDirection::Buy, m_conf.Quantity(), buyVwap, worst )
+			 && m_orderBook.Sweep(
+				 OrderDirection::Sell, m_conf.Quantity(), sellVwap, worst ) ) {
+
+			ZUBR_LOG_DEBUG( "[" << m_conf.InstrumentId() << "] sweep "
+								<< m_conf.Quantity() << ": BUY " << buyVwap
+								<< ", SELL " << sellVwap );
+		}
+	}
+
+	if ( m_pendingSync & SyncBook ) {
+		onSynced( SyncBook, "book" );
+	}
+}
+
+void quoter::invalidateBook( const char * reason )
+{
+	ZUBR_LOG_ERROR( "[" << m_conf.InstrumentId() << "] order book "
+						<< reason << ", resubscribing" );
+
+	m_orderBook.Clear();
+	m_bestBuyPrice = Number();
+	m_bestSellPrice = Number();
+
+	m_hasBookSnapshot = false;
+	m_pendingSync |= SyncBook;
+
+	requestBookSnapshot();
+}
+
+void quoter::requestBookSnapshot()
+{
+	if ( m_isBookResubscribeRequested ) {
+		return;
+	}
+
+	m_isBookResubscribeRequested = true;
+	m_sink.ResubscribeOrderBook();
+
+	auto generation = m_syncGeneration;
+
+	// the retry ends with the connection, the new one subscribes anew
+	m_sink.SetTimer( BookResubscribeRetryMs, [this, generation]() {
+		if ( generation == m_syncGeneration && !m_hasBookSnapshot ) {
+			m_isBookResubscribeRequested = false;
+			requestBookSnapshot();
+		}
+	} );
+}
+
+void quoter::onOrderUpdate( const orderUpdateEvent & order )
+{
+	orderTable & ordersMap = order.direction == OrderDirection::Buy
+								 ? m_buyOrdersMap
+								 : m_sellOrdersMap;
+
+	bool & isOrderPlaced = order.direction == OrderDirection::Buy
+							   ? m_isBuyOrderPlaced
+							   : m_isSellOrderPlaced;
+
+	auto itOrderMap = ordersMap.find( order.id );
+
+	if ( ordersMap.end() != itOrderMap ) {
+		if ( order.status == OrderStatus::Filled
+			 || order.status == OrderStatus::PartiallyFilled ) {
+
+			// the position follows the fills channel
+			auto ordersFilledCount
+				= itOrderMap->second.quantity - order.quantityRemaining;
+
+			itOrderMap->second.quantity = order.quantityRemaining;
+			m_riskGate.OnFill( order.direction, ordersFilledCount );
+
+			if ( order.quantityRemaining == 0 ) {
+				m_riskGate.OnRemove( order.direction, 0 );
+				ordersMap.erase( order.id );
+				isOrderPlaced = false;
+			}
+		}
+		else if ( order.status == OrderStatus::Cancelled ) {
+			auto & record = itOrderMap->second;
+
+			m_riskGate.OnRemove( order.direction, record.quantity );
+
+			// while resynchronizing the order is placed again by quote(),
+			// ladder levels are placed again by the ladder diff
+			if ( record.isCancelSent && record.quantity > 0 && IsSynced()
+				 && !m_isSuspended && !m_conf.Ladder().IsEnabled() ) {
+
+				placeOrder( order.direction, record.quantity, isOrderPlaced );
+			}
+			else {
+				isOrderPlaced = false;
+			}
+
+			ordersMap.erase( order.id );
+		}
+	}
+}
+
+void quoter::onFill( const fillEvent & fill )
+{
+	// the positions snapshot to come includes the fill
+	if ( !IsPositionKnown() ) {
+		return;
+	}
+
+	m_positionSize = m_ledger.OnFill( m_positionSize,
+		fill.direction,
+		fill.quantity,
+		fill.price,
+		fill.fee );
+
+	ZUBR_LOG_INFO( "[" << m_conf.InstrumentId() << "] filled "
+					   << OrderEnumHelper::ToString( fill.direction ) << " "
+					   << fill.quantity << " @ " << fill.price
+					   << ", order: " << fill.orderId
+					   << ", position size: " << m_positionSize
+					   << ", entry: " << m_ledger.EntryPrice()
+					   << ", realized pnl: " << m_ledger.RealizedPnl()
+					   << ", fees: " << m_ledger.Fees() );
+
+	ZUBR_LOG_DEBUG( "[" << m_conf.InstrumentId() << "] fill delay, us: "
+						<< ( fill.receivedAtNs - fill.tradeTimeNs ) / 1000 );
+}
+
+void quoter::onPlaceOrderResponse(
+	const std::shared_ptr<PlaceOrderRequestWs> & req,
+	const PlaceOrderResponseWs & res )
+{
+
+	auto itPending
+		= std::find( m_ladderPending.begin(), m_ladderPending.end(), req );
+
+	if ( m_ladderPending.end() != itPending ) {
+		m_ladderPending.erase( itPending );
+	}
+
+	if ( !res.IsOk() ) {
+		m_riskGate.OnRemove( req->Direction(), req->Quantity() );
+
+		if ( req->Direction() == OrderDirection::Buy ) {
+			ZUBR_LOG_ERROR( "[" << m_conf.InstrumentId()
+								<< "] BUY order rejected: "
+								<< res.ErrorCodeName() );
+
+			m_isBuyOrderPlaced = false;
+		}
+		else if ( req->Direction() == OrderDirection::Sell ) {
+			ZUBR_LOG_ERROR( "[" << m_conf.InstrumentId()
+								<< "] SELL order rejected: "
+								<< res.ErrorCodeName() );
+
+			m_isSellOrderPlaced = false;
+		}
+	}
+	else {
+		auto & record = ( req->Direction() == OrderDirection::Buy
+							  ? m_buyOrdersMap
+							  : m_sellOrdersMap )[res.OrderId()];
+
+		record = orderRecord::Of( *req );
+
+		// placed before the suspension
+		if ( m_isSuspended ) {
+			record.isCancelSent = true;
+			cancelOrder( res.OrderId() );
+		}
+	}
+}
+
+void quoter::onResync()
+{
+	ZUBR_LOG_INFO( "[" << m_conf.InstrumentId() << "] resynchronizing..." );
+
+	m_pendingSync = SyncAll;
+
+	m_orderBook.Clear();
+	m_bestBuyPrice = Number();
+	m_bestSellPrice = Number();
+
+	// the new subscription repeats the recent trades
+	m_tape.Clear();
+
+	// the new subscription starts with a snapshot
+	m_hasBookSnapshot = false;
+	m_isBookResubscribeRequested = false;
+
+	// responses to place requests sent before the disconnect are lost,
+	// placed orders are found in the orders snapshot
+	m_ladderPending.clear();
+	m_isBuyOrderPlaced = !m_buyOrdersMap.empty();
+	m_isSellOrderPlaced = !m_sellOrdersMap.empty();
+	syncRiskGate();
+
+	// timers of the previous connection are stale
+	++m_syncGeneration;
+}
+
+void quoter::onConnected()
+{
+	if ( IsSynced() ) {
+		return;
+	}
+
+	// the snapshots are only sent once the new connection is
+	// authenticated
+	auto generation = m_syncGeneration;
+
+	m_sink.SetTimer( SyncTimeoutMs, [this, generation]() {
+		if ( generation == m_syncGeneration && !IsSynced() ) {
+			onSyncTimeout();
+		}
+	} );
+}
+
+void quoter::onOrdersSnapshot( const ordersSnapshotEvent & ev )
+{
+	std::unordered_map<t_order_id, const orderUpdateEvent *> exchangeOrders;
+
+	for ( auto & order : ev.orders ) {
+		exchangeOrders[order.id] = &order;
+	}
+
+	std::vector<t_order_id> gone;
+
+	for ( auto * ordersMap : { &m_buyOrdersMap, &m_sellOrdersMap } ) {
+		gone.clear();
+
+		for ( auto & itOrder : *ordersMap ) {
+			auto itExchange = exchangeOrders.find( itOrder.first );
+
+			// filled or cancelled while disconnected
+			if ( exchangeOrders.end() == itExchange ) {
+				ZUBR_LOG_INFO( "[" << m_conf.InstrumentId() << "] order "
+								   << itOrder.first << " is gone" );
+
+				gone.push_back( itOrder.first );
+				continue;
+			}
+
+			auto & record = itOrder.second;
+			auto & order = *itExchange->second;
+
+			// the position snapshot is authoritative otherwise
+			if ( m_conf.UseConfigStartPositionSize() ) {
+				auto filled = record.quantity - order.quantityRemaining;
+
+				m_positionSize += ( OrderDirection::Buy == order.direction
+										? filled
+										: -filled );
+			}
+
+			record.quantity = order.quantityRemaining;
+
+			// the cancel may have been lost with the connection
+			if ( record.isCancelSent ) {
+				cancelOrder( itOrder.first );
+			}
+
+			exchangeOrders.erase( itExchange );
+		}
+
+		// erasing shifts entries, not done while iterating
+		for ( auto orderId : gone ) {
+			ordersMap->erase( orderId );
+		}
+	}
+
+	// placed before the disconnect, the response never arrived
+	for ( auto & itExchange : exchangeOrders ) {
+		ZUBR_LOG_INFO( "[" << m_conf.InstrumentId()
+						   << "] cancelling unknown order "
+						   << itExchange.first );
+
+		cancelOrder( itExchange.first );
+	}
+
+	m_isBuyOrderPlaced = !m_buyOrdersMap.empty();
+	m_isSellOrderPlaced = !m_sellOrdersMap.empty();
+	syncRiskGate();
+
+	onSynced( SyncOrders, "orders" );
+}
+
+void quoter::onSyncTimeout()
+{
+	ZUBR_LOG_ERROR( "[" << m_conf.InstrumentId()
+						<< "] resynchronization timed out, pending: "
+						<< m_pendingSync );
+
+	if ( m_pendingSync & SyncOrders ) {
+		for ( auto * ordersMap : { &m_buyOrdersMap, &m_sellOrdersMap } ) {
+			for ( auto & itOrder : *ordersMap ) {
+				cancelOrder( itOrder.first );
+			}
+
+			ordersMap->clear();
+		}
+
+		m_isBuyOrderPlaced = false;
+		m_isSellOrderPlaced = false;
+		syncRiskGate();
+	}
+
+	// quoting still waits for the book to have both sides
+	m_pendingSync = 0;
+	quote();
+}
+
+void quoter::onSynced( syncState state, const char * name )
+{
+	m_pendingSync &= ~state;
+
+	ZUBR_LOG_INFO( "[" << m_conf.InstrumentId() << "] " << name
+					   << " resynchronized" );
+
+	if ( IsSynced() ) {
+		ZUBR_LOG_INFO(
+			"[" << m_conf.InstrumentId() << "] resynchronized, quoting" );
+	}
+}
+
+void quoter::pullQuotes()
+{
+	m_sink.BeginBurst();
+
+	for ( auto * ordersMap : { &m_buyOrdersMap, &m_sellOrdersMap } ) {
+		for ( auto & itOrder : *ordersMap ) {
+			if ( !itOrder.second.isCancelSent ) {
+				itOrder.second.isCancelSent = true;
+				cancelOrder( itOrder.first );
+			}
+		}
+	}
+
+	m_sink.EndBurst();
+}
+
+bool quoter::checkRiskBreach()
+{
+	if ( m_isHalted ) {
+		return true;
+	}
+
+	const char * reason = nullptr;
+
+	if ( !IsPositionKnown()
+		 || !m_riskGate.IsBreached( m_positionSize,
+			 m_orderBook.IsValid() ? m_orderBook.Mid() : 0,
+			 reason ) ) {
+
+		return false;
+	}
+
+	ZUBR_LOG_ERROR( "[" << m_conf.InstrumentId() << "] risk limit breached: "
+						<< reason << ", position size: " << m_positionSize
+						<< ", halting" );
+
+	m_isHalted = true;
+	m_isSuspended = true;
+	m_sink.CancelAll( reason );
+
+	return true;
+}
+
+void quoter::quote()
+{
+	if ( !IsSynced() || checkRiskBreach() || m_isSuspended ) {
+		return;
+	}
+
+	if ( m_bestBuyPrice.HasValue() && m_bestSellPrice.HasValue()
+		 && m_minPriceIncrement.HasValue() && IsPositionKnown() ) {
+
+		if ( !m_isBuyOrderPlaced && m_positionSize < m_conf.PositionSizeMax()
+			 && m_buyOrdersMap.empty() && !m_conf.Ladder().IsEnabled() ) {
+
+			placeOrder(
+				OrderDirection::Buy, m_conf.Quantity(), m_isBuyOrderPlaced );
+		}
+
+		if ( !m_isSellOrderPlaced && m_positionSize > -m_conf.PositionSizeMax()
+			 && m_sellOrdersMap.empty() && !m_conf.Ladder().IsEnabled() ) {
+
+			placeOrder(
+				OrderDirection::Sell, m_conf.Quantity(), m_isSellOrderPlaced );
+		}
+
+		ZUBR_LOG_INFO( "[" << m_conf.InstrumentId()
+						   << "] position size: " << m_positionSize );
+
+		if ( m_conf.Ladder().IsEnabled() ) {
+			quoteLadder();
+			return;
+		}
+
+		replaceOrderIfPriceChanged( OrderDirection::Buy );
+		replaceOrderIfPriceChanged( OrderDirection::Sell );
+	}
+}
+
+void quoter::quoteLadder()
+{
+	if ( m_isLadderDeferred ) {
+		return;
+	}
+
+	auto now = t_clock::now();
+	auto retryAt = t_clock::time_point::max();
+
+	auto & cancels = m_ladderCancels;
+	auto & places = m_ladderPlaces;
+	cancels.clear();
+	places.clear();
+
+	diffLadder( OrderDirection::Buy, now, cancels, places, retryAt );
+	diffLadder( OrderDirection::Sell, now, cancels, places, retryAt );
+
+	int count = cancels.size() + places.size();
+
+	if ( count > 0 ) {
+		t_clock::time_point budgetAt;
+
+		if ( !m_quotePolicy.IsBurstAvailable( now, count, budgetAt ) ) {
+			places.clear();
+			deferLadder( budgetAt - now );
+			return;
+		}
+
+		ZUBR_LOG_INFO( "[" << m_conf.InstrumentId()
+						   << "] ladder: " << cancels.size()
+						   << " cancels, " << places.size() << " places" );
+
+		// cancels first, their margin is released for the placements
+		m_sink.BeginBurst();
+
+		for ( auto orderId : cancels ) {
+			// the cancel is sent, confirmed by the orders channel
+			for ( auto * ordersMap : { &m_buyOrdersMap, &m_sellOrdersMap } ) {
+				auto itOrder = ordersMap->find( orderId );
+
+				if ( ordersMap->end() != itOrder ) {
+					itOrder->second.isCancelSent = true;
+				}
+			}
+
+			cancelOrder( orderId );
+		}
+
+		for ( auto & req : places ) {
+			if ( submitOrder( req, now ) ) {
+				m_ladderPending.push_back( req );
+			}
+		}
+
+		m_sink.EndBurst();
+
+		m_quotePolicy.OnBurst( now, count );
+
+		// the requests go back to the pool once acknowledged
+		places.clear();
+	}
+
+	if ( t_clock::time_point::max() != retryAt ) {
+		deferLadder( retryAt - now );
+	}
+}
+
+void quoter::diffLadder( OrderDirection direction,
+	t_clock::time_point now,
+	std::vector<t_order_id> & cancels,
+	std::vector<std::shared_ptr<PlaceOrderRequestWs>> & places,
+	t_clock::time_point & retryAt )
+{
+
+	auto & ordersMap
+		= OrderDirection::Buy == direction ? m_buyOrdersMap : m_sellOrdersMap;
+
+	auto & base = m_ladderBase[OrderDirection::Buy == direction ? 0 : 1];
+	auto tick = m_minPriceIncrement.Value();
+
+	auto toTick = [tick]( const Number & price ) {
+		return std::llround( price.Value() / tick );
+	};
+
+	// orders the ladder is made of: resting ones, except those with a
+	// cancel sent, and placements in flight
+	auto & live = m_ladderLive;
+	live.clear();
+
+	for ( auto & itOrder : ordersMap ) {
+		if ( !itOrder.second.isCancelSent ) {
+			live.push_back( liveOrder{
+				toTick( itOrder.second.Price() ), itOrder.first, false } );
+		}
+	}
+
+	for ( auto & req : m_ladderPending ) {
+		if ( req->Direction() == direction ) {
+			live.push_back( liveOrder{ toTick( req->Price() ), 0, false } );
+		}
+	}
+
+	auto price = calculateOrderPrice( direction );
+
+	// a shift of the whole ladder is throttled as a requote, missing
+	// levels are filled at the current base meanwhile
+	if ( !live.empty() && base.HasValue() ) {
+		t_clock::time_point shiftAt;
+
+		switch ( m_quotePolicy.Check(
+			direction, base, price, m_minPriceIncrement, now, shiftAt ) ) {
+
+			case quotePolicy::decision::Requote:
+				m_quotePolicy.OnShift( direction, now );
+				base = price;
+				break;
+
+			case quotePolicy::decision::Defer:
+				retryAt = std::min( retryAt, shiftAt );
+				break;
+
+			default:
+				break;
+		}
+	}
+	else {
+		base = price;
+	}
+
+	int cumulative = 0;
+	auto sign = ( OrderDirection::Buy == direction ? -1 : 1 );
+
+	for ( auto & level : m_conf.Ladder().Levels() ) {
+		bool isAllowed = ( OrderDirection::Buy == direction
+							   ? m_positionSize + cumulative
+									 < m_conf.PositionSizeMax()
+							   : m_positionSize - cumulative
+									 > -m_conf.PositionSizeMax() );
+
+		if ( !isAllowed ) {
+			break;
+		}
+
+		cumulative += level.quantity;
+
+		Number levelPrice = base;
+		levelPrice.Add( sign * level.offsetTicks * tick )
+			.ModRing( m_minPriceIncrement );
+
+		auto levelTick = toTick( levelPrice );
+
+		auto itLive = std::find_if(
+			live.begin(), live.end(), [levelTick]( const liveOrder & o ) {
+				return ( !o.isMatched && o.tick == levelTick );
+			} );
+
+		if ( live.end() != itLive ) {
+			itLive->isMatched = true;
+			continue;
+		}
+
+		places.push_back( newOrder( levelPrice, direction, level.quantity ) );
+	}
+
+	// resting orders off the ladder, placements in flight are diffed once
+	// their order ID is known
+	for ( auto & o : live ) {
+		if ( !o.isMatched && 0 != o.id ) {
+			// marked once the burst is sent, a deferred ladder keeps them
+			cancels.push_back( o.id );
+		}
+	}
+}
+
+void quoter::deferLadder( t_clock::duration delay )
+{
+	if ( m_isLadderDeferred ) {
+		return;
+	}
+
+	m_isLadderDeferred = true;
+
+	m_sink.SetTimer(
+		std::chrono::duration_cast<std::chrono::milliseconds>( delay ).count()
+			+ 1,
+		[this]() {
+			m_isLadderDeferred = false;
+
+			if ( IsSynced() ) {
+				quote();
+			}
+		} );
+}
+
+void quoter::OnEvent( const Instrument & instrument )
+{
+	m_minPriceIncrement = instrument.MinPriceIncrement();
+
+	// the book is rebuilt at the new tick size
+	if ( m_orderBook.TickSize( m_minPriceIncrement )
+		 && ( m_hasBookSnapshot || m_isBookDeferred ) ) {
+
+		m_isBookDeferred = false;
+		m_hasBookSnapshot = false;
+		m_bestBuyPrice = Number();
+		m_bestSellPrice = Number();
+
+		requestBookSnapshot();
+	}
+
+	quote();
+}
+
+void quoter::OnEvent( const OrderBookEntry & entry )
+{
+	onOrderBook( entry );
+	quote();
+}
+
+void quoter::OnEvent( const positionSizeEvent & ev )
+{
+	if ( ev.isSnapshot && ( m_pendingSync & SyncPosition ) ) {
+		if ( m_conf.UseConfigStartPositionSize() ) {
+			ZUBR_LOG_INFO( "[" << m_conf.InstrumentId()
+							   << "] exchange position size: " << ev.size
+							   << ", local: " << m_positionSize );
+
+			// the exchange entry holds for the local size only if equal
+			if ( ev.size == m_positionSize ) {
+				m_ledger.EntryPrice( ev.entryPrice );
+			}
+		}
+		else {
+			m_positionSize = ev.size;
+			m_ledger.EntryPrice( ev.entryPrice );
+		}
+
+		onSynced( SyncPosition, "position" );
+	}
+	else if ( !IsPositionKnown() ) {
+		m_positionSize = ev.size;
+		m_ledger.EntryPrice( ev.entryPrice );
+
+		ZUBR_LOG_INFO( "[" << m_conf.InstrumentId()
+						   << "] exchange position size: " << m_positionSize );
+	}
+
+	quote();
+}
+
+void quoter::OnEvent( const fillEvent & ev )
+{
+	onFill( ev );
+	quote();
+}
+
+void quoter::OnEvent( const tradeEvent & ev )
+{
+	m_tape.OnTrade( ev.at, ev.price, ev.quantity, ev.direction );
+
+	// the interest follows the volatility
+	if ( 0 != m_conf.Tape().VolatilityFactor() ) {
+		quote();
+	}
+}
+
+void quoter::OnEvent( const orderUpdateEvent & order )
+{
+	onOrderUpdate( order );
+	quote();
+}
+
+void quoter::OnEvent( const ordersSnapshotEvent & ev )
+{
+	if ( m_pendingSync & SyncOrders ) {
+		onOrdersSnapshot( ev );
+	}
+
+	quote();
+}
+
+void quoter::OnEvent( const placeOrderResultEvent & ev )
+{
+	onPlaceOrderResponse( ev.req, ev.res );
+	quote();
+}
+
+void quoter::OnEvent( const resyncEvent & )
+{
+	onResync();
+}
+
+void quoter::OnEvent( const connectedEvent & )
+{
+	onConnected();
+}
+
+void quoter::OnEvent( const suspendEvent & ev )
+{
+	if ( m_isHalted ) {
+		return;
+	}
+
+	m_isSuspended = ev.isSuspended;
+
+	if ( m_isSuspended ) {
+		ZUBR_LOG_INFO( "[" << m_conf.InstrumentId()
+						   << "] quoting suspended, pulling "
+						   << m_buyOrdersMap.size() + m_sellOrdersMap.size()
+						   << " orders" );
+
+		pullQuotes();
+		return;
+	}
+
+	ZUBR_LOG_INFO( "[" << m_conf.InstrumentId() << "] quoting resumed" );
+
+	quote();
+}
@@ -0,0 +1,447 @@
+/*
+MIT License
+
+Copyright (c) 2020 Denis Rozhkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// quoter.hpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#ifndef __ZUBROBOT_QUOTER__H
+#define __ZUBROBOT_QUOTER__H
+
+
+#include <climits>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+#include "zubr-core/BlockPool.hpp"
+#include "zubr-core/FlatMap.hpp"
+
+#include "zubr-connector-ws/Request.hpp"
+#include "zubr-connector-ws/Response.hpp"
+
+#include "conf.hpp"
+#include "orderBook.hpp"
+#include "positionLedger.hpp"
+#include "quotePolicy.hpp"
+#include "riskGate.hpp"
+#include "tradeTape.hpp"
+
+
+namespace zubr {
+
+	struct positionSizeEvent {
+		int size;
+		/// @brief size comes from the positions snapshot
+		bool isSnapshot;
+		/// @brief average entry price, 0 - flat or unknown
+		double entryPrice;
+	};
+
+	/// @brief own trade from the order fills channel, the position is
+	/// updated from fills only
+	struct fillEvent {
+		t_order_id orderId;
+		OrderDirection direction;
+		int quantity;
+		double price;
+		double fee;
+		/// @brief exchange time of the trade, ns since the epoch
+		int64_t tradeTimeNs;
+		/// @brief system clock, ns since the epoch, when decoded
+		int64_t receivedAtNs;
+	};
+
+	/// @brief public trade from the last trades channel
+	struct tradeEvent {
+		/// @brief exchange time of the trade on the local clock
+		t_clock::time_point at;
+		double price;
+		int quantity;
+		OrderDirection direction;
+	};
+
+	/// @brief order fields the quoter uses, decoded from the orders
+	/// channel entry on the connector thread
+	struct orderUpdateEvent {
+		t_order_id id;
+		OrderDirection direction;
+		OrderStatus status;
+		int quantityRemaining;
+	};
+
+	/// @brief open orders of the instrument from the orders snapshot
+	struct ordersSnapshotEvent {
+		std::vector<orderUpdateEvent> orders;
+	};
+
+	struct placeOrderResultEvent {
+		std::shared_ptr<PlaceOrderRequestWs> req;
+		PlaceOrderResponseWs res;
+	};
+
+	/// @brief resting order state, kept inline in the order tables
+	struct orderRecord {
+		int64_t priceSignificand;
+		int quantity;
+		int8_t priceExponent;
+		/// @brief cancel sent, in single order mode the order is placed
+		/// again once the cancel is confirmed
+		bool isCancelSent;
+
+		static orderRecord Of( const PlaceOrderRequestWs & req )
+		{
+			return orderRecord{ req.Price().Significand(),
+				req.Quantity(),
+				static_cast<int8_t>( req.Price().Exponent() ),
+				false };
+		}
+
+		Number Price() const
+		{
+			return Number( priceSignificand, priceExponent );
+		}
+
+		void Price( const Number & price )
+		{
+			priceSignificand = price.Significand();
+			priceExponent = static_cast<int8_t>( price.Exponent() );
+		}
+	};
+
+	/// @brief resting orders of one side by order ID
+	typedef FlatMap<t_order_id, orderRecord> orderTable;
+
+	/// @brief connection is lost, local state is to be rebuilt from the
+	/// snapshots sent after reconnect
+	struct resyncEvent {
+	};
+
+	/// @brief new connection is authenticated, the snapshots follow
+	struct connectedEvent {
+	};
+
+	/// @brief quoting is to stop and resting orders to be pulled, or
+	/// quoting may resume
+	struct suspendEvent {
+		bool isSuspended;
+	};
+
+	/// @brief per instrument event, self contained to be queued between
+	/// threads
+	typedef std::variant<Instrument,
+		OrderBookEntry,
+		positionSizeEvent,
+		fillEvent,
+		tradeEvent,
+		orderUpdateEvent,
+		ordersSnapshotEvent,
+		placeOrderResultEvent,
+		resyncEvent,
+		connectedEvent,
+		suspendEvent>
+		quoterEvent;
+
+
+	/// @brief outbound side of a quoter
+	class orderSink {
+	public:
+		/// @brief send place order request, the response is passed back
+		/// to quoter::OnPlaceOrderResponse
+		virtual void PlaceOrder(
+			const std::shared_ptr<PlaceOrderRequestWs> & req )
+			= 0;
+
+		virtual void CancelOrder( t_order_id orderId ) = 0;
+
+		/// @brief request a fresh order book snapshot (resubscribe)
+		virtual void ResubscribeOrderBook() = 0;
+
+		/// @brief cancel every order of every instrument and halt quoting
+		/// @param reason static string, for logging
+		virtual void CancelAll( const char * reason ) = 0;
+
+		/// @brief requests until EndBurst() may be sent together
+		virtual void BeginBurst()
+		{
+		}
+
+		virtual void EndBurst()
+		{
+		}
+
+		/// @brief invoke handler in the quoter context after a delay
+		virtual void SetTimer(
+			long milliseconds, const std::function<void()> & handler )
+			= 0;
+	};
+
+	/// @brief quoting state and logic of a single instrument
+	class quoter {
+	protected:
+		/// @brief state still to be confirmed by the exchange after
+		/// reconnect
+		enum syncState {
+			SyncBook = 1,
+			SyncOrders = 2,
+			SyncPosition = 4,
+			SyncAll = SyncBook | SyncOrders | SyncPosition
+		};
+
+		static constexpr long SyncTimeoutMs = 5000;
+		static constexpr long BookResubscribeRetryMs = 2000;
+
+		/// @brief resting orders per side held without rehashing
+		static constexpr size_t OrderTableCapacity = 64;
+
+		/// @brief ladder order of one side while diffing
+		struct liveOrder {
+			int64_t tick;
+			t_order_id id;
+			bool isMatched;
+		};
+
+	protected:
+		confInstrument m_conf;
+		orderSink & m_sink;
+		BlockPool & m_orderPool;
+
+		Number m_minPriceIncrement;
+		Number m_bestBuyPrice;
+		Number m_bestSellPrice;
+		int m_positionSize;
+
+		bool m_isBuyOrderPlaced;
+		bool m_isSellOrderPlaced;
+
+		orderTable m_sellOrdersMap;
+		orderTable m_buyOrdersMap;
+
+		orderBook m_orderBook;
+
+		quotePolicy m_quotePolicy;
+		riskGate m_riskGate;
+		positionLedger m_ledger;
+		tradeTape m_tape;
+
+		/// @brief ladder placements waiting for the response
+		std::vector<std::shared_ptr<PlaceOrderRequestWs>> m_ladderPending;
+		/// @brief operations of the ladder diff, kept to reuse the memory
+		std::vector<t_order_id> m_ladderCancels;
+		std::vector<std::shared_ptr<PlaceOrderRequestWs>> m_ladderPlaces;
+		std::vector<liveOrder> m_ladderLive;
+		/// @brief quote price the ladder of each side was built around
+		Number m_ladderBase[2];
+		bool m_isLadderDeferred;
+
+		int m_pendingSync;
+		unsigned m_syncGeneration;
+
+		bool m_hasBookSnapshot;
+		bool m_isBookResubscribeRequested;
+		/// @brief book message dropped while the tick size was unknown
+		bool m_isBookDeferred;
+
+		/// @brief quoting stopped by the latency breaker or a halt
+		bool m_isSuspended;
+		/// @brief quoting stopped for good by a risk breach
+		bool m_isHalted;
+
+	protected:
+		/// @brief configured reference price, skewed by the imbalance
+		double referencePrice() const;
+
+		/// @brief configured interest widened by the realized volatility
+		/// of the trade tape
+		/// @param price reference price the volatility is scaled by
+		double interest( double price );
+
+		Number calculateOrderPrice( OrderDirection direction );
+
+		/// @brief limit GTC order taken from the order pool
+		std::shared_ptr<PlaceOrderRequestWs> newOrder(
+			const Number & price, OrderDirection direction, int quantity );
+
+		void placeOrder(
+			OrderDirection direction, int quantity, bool & isPlaced );
+
+		/// @brief pass placement through the risk gate to the sink
+		/// @return false if rejected, the quantity may be clipped
+		bool submitOrder( const std::shared_ptr<PlaceOrderRequestWs> & req,
+			t_clock::time_point now );
+
+		void cancelOrder( t_order_id orderId );
+
+		/// @brief recount risk gate counters from the open orders
+		void syncRiskGate();
+
+		void replaceOrderIfPriceChanged( OrderDirection direction );
+
+		/// @brief replace the book with a snapshot or apply a delta
+		void onOrderBook( const OrderBookEntry & entry );
+
+		/// @brief drop a corrupt book and stop quoting until a new snapshot
+		/// @param reason for logging
+		void invalidateBook( const char * reason );
+
+		/// @brief resubscribe, retried while no snapshot arrives
+		void requestBookSnapshot();
+		void onOrderUpdate( const orderUpdateEvent & order );
+
+		/// @brief account fill in the position and the ledger
+		void onFill( const fillEvent & fill );
+
+		void onPlaceOrderResponse(
+			const std::shared_ptr<PlaceOrderRequestWs> & req,
+			const PlaceOrderResponseWs & res );
+
+		/// @brief drop the book and hold quoting until book, orders and
+		/// position are confirmed again
+		void onResync();
+
+		/// @brief start waiting for the snapshots of the new connection
+		void onConnected();
+
+		/// @brief align local orders with the exchange open orders
+		void onOrdersSnapshot( const ordersSnapshotEvent & ev );
+
+		/// @brief give up waiting for the orders snapshot, cancel every
+		/// known order and resume
+		void onSyncTimeout();
+
+		/// @brief mark part of the state as confirmed
+		/// @param state
+		/// @param name for logging
+		void onSynced( syncState state, const char * name );
+
+		/// @brief cancel every resting order in one burst, orders with a
+		/// cancel already sent are skipped
+		void pullQuotes();
+
+		/// @brief halt quoting if the position breaches the risk limits
+		/// @return true if halted
+		bool checkRiskBreach();
+
+		/// @brief place missing orders and requote resting ones
+		void quote();
+
+		/// @brief diff both ladders against the resting orders and send
+		/// the changes as one burst
+		void quoteLadder();
+
+		/// @brief operations turning the resting orders of the side into
+		/// the ladder, orders already at a ladder price are kept
+		/// @param direction
+		/// @param now
+		/// @param cancels
+		/// @param places
+		/// @param retryAt set if a shift of the ladder is deferred
+		void diffLadder( OrderDirection direction,
+			t_clock::time_point now,
+			std::vector<t_order_id> & cancels,
+			std::vector<std::shared_ptr<PlaceOrderRequestWs>> & places,
+			t_clock::time_point & retryAt );
+
+		/// @brief re-run quoteLadder() after the delay
+		void deferLadder( t_clock::duration delay );
+
+		/// @brief re-run requote of the side once the policy allows it
+		/// @param direction
+		/// @param delay
+		void deferRequote( OrderDirection direction, t_clock::duration delay );
+
+	public:
+		quoter( const confInstrument & conf,
+			orderSink & sink,
+			messageBudget & budget,
+			BlockPool & orderPool )
+			: m_conf( conf )
+			, m_sink( sink )
+			, m_orderPool( orderPool )
+			, m_isBuyOrderPlaced( false )
+			, m_isSellOrderPlaced( false )
+			, m_sellOrdersMap( OrderTableCapacity )
+			, m_buyOrdersMap( OrderTableCapacity )
+			, m_orderBook( conf.Pricing().DepthTicks(),
+				  conf.Pricing().ImbalanceTicks() )
+			, m_quotePolicy( conf.QuotePolicy(), budget )
+			, m_riskGate( conf.Risk() )
+			, m_tape( conf.Tape() )
+			, m_isLadderDeferred( false )
+			, m_pendingSync( 0 )
+			, m_syncGeneration( 0 )
+			, m_hasBookSnapshot( false )
+			, m_isBookResubscribeRequested( false )
+			, m_isBookDeferred( false )
+			, m_isSuspended( false )
+			, m_isHalted( false )
+		{
+
+			m_positionSize = conf.UseConfigStartPositionSize()
+								 ? conf.PositionSizeStart()
+								 : INT_MAX;
+		}
+
+		t_instrument_id InstrumentId() const
+		{
+			return m_conf.InstrumentId();
+		}
+
+		bool IsPositionKnown() const
+		{
+			return ( m_positionSize != INT_MAX );
+		}
+
+		/// @brief no resynchronization in progress
+		bool IsSynced() const
+		{
+			return ( 0 == m_pendingSync );
+		}
+
+		/// @brief handle event and quote
+		void OnEvent( const Instrument & instrument );
+		void OnEvent( const OrderBookEntry & entry );
+		void OnEvent( const positionSizeEvent & ev );
+		void OnEvent( const fillEvent & ev );
+		void OnEvent( const tradeEvent & ev );
+		void OnEvent( const orderUpdateEvent & order );
+		void OnEvent( const ordersSnapshotEvent & ev );
+		void OnEvent( const placeOrderResultEvent & ev );
+		void OnEvent( const resyncEvent & ev );
+		void OnEvent( const connectedEvent & ev );
+		void OnEvent( const suspendEvent & ev );
+
+		void OnEvent( const quoterEvent & ev )
+		{
+			std::visit( [this]( auto & e ) { OnEvent( e ); }, ev );
+		}
+	};
+
+} // namespace zubr
+
+
+#endif
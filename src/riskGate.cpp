@@ -0,0 +1,153 @@
+/*
+MIT License
+
+Copyright (c) 2020 Denis Rozhkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// riskGate.cpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "riskGate.hpp"
+
+
+using namespace zubr;
+
+
+riskGate::riskGate( const confRisk & conf )
+	: m_conf( conf )
+	, m_messageBudget( conf.MaxMessagesPerSecond() )
+	, m_openOrders( 0 )
+	, m_openQuantity{ 0, 0 }
+{
+}
+
+int riskGate::Check( const PlaceOrderRequestWs & req,
+	int positionSize,
+	double referencePrice,
+	t_clock::time_point now,
+	const char *& reason ) const
+{
+
+	auto price = req.Price().Value();
+	auto side = sideIndex( req.Direction() );
+
+	if ( m_conf.PriceBandPercent() > 0 && referencePrice > 0
+		 && std::abs( price - referencePrice )
+				> referencePrice * m_conf.PriceBandPercent() / 100 ) {
+
+		reason = "price band";
+		return 0;
+	}
+
+	if ( m_conf.MaxOpenOrders() > 0
+		 && m_openOrders >= m_conf.MaxOpenOrders() ) {
+
+		reason = "open orders";
+		return 0;
+	}
+
+	t_clock::time_point retryAt;
+
+	if ( !m_messageBudget.IsAvailable( now, 1, retryAt ) ) {
+		reason = "message rate";
+		return 0;
+	}
+
+	int64_t quantity = req.Quantity();
+
+	if ( m_conf.MaxOrderQuantity() > 0
+		 && quantity > m_conf.MaxOrderQuantity() ) {
+
+		reason = "order quantity";
+		quantity = m_conf.MaxOrderQuantity();
+	}
+
+	if ( m_conf.MaxOpenQuantity() > 0
+		 && m_openQuantity[side] + quantity > m_conf.MaxOpenQuantity() ) {
+
+		reason = "open quantity";
+		quantity = m_conf.MaxOpenQuantity() - m_openQuantity[side];
+	}
+
+	// position plus open orders of the side, if all filled
+	if ( m_conf.MaxNotional() > 0 && price > 0 ) {
+		int64_t exposure = ( OrderDirection::Buy == req.Direction()
+								 ? positionSize
+								 : -positionSize )
+						   + m_openQuantity[side];
+
+		auto room = static_cast<int64_t>( m_conf.MaxNotional() / price )
+					- exposure;
+
+		if ( quantity > room ) {
+			reason = "notional";
+			quantity = room;
+		}
+	}
+
+	return static_cast<int>( std::max<int64_t>( quantity, 0 ) );
+}
+
+bool riskGate::IsBreached(
+	int positionSize, double referencePrice, const char *& reason ) const
+{
+
+	if ( m_conf.MaxPosition() > 0
+		 && std::abs( positionSize ) > m_conf.MaxPosition() ) {
+
+		reason = "position";
+		return true;
+	}
+
+	if ( m_conf.MaxNotional() > 0 && referencePrice > 0
+		 && std::abs( positionSize ) * referencePrice
+				> m_conf.MaxNotional() ) {
+
+		reason = "position notional";
+		return true;
+	}
+
+	return false;
+}
+
+void riskGate::OnPlace(
+	OrderDirection direction, int quantity, t_clock::time_point now )
+{
+
+	++m_openOrders;
+	m_openQuantity[sideIndex( direction )] += quantity;
+	m_messageBudget.Consume( now, 1 );
+}
+
+void riskGate::Reset(
+	int openOrders, int64_t openBuyQuantity, int64_t openSellQuantity )
+{
+
+	m_openOrders = openOrders;
+	m_openQuantity[0] = openBuyQuantity;
+	m_openQuantity[1] = openSellQuantity;
+}
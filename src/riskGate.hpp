@@ -0,0 +1,127 @@
+/*
+MIT License
+
+Copyright (c) 2020 Denis Rozhkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// riskGate.hpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#ifndef __ZUBROBOT_RISK_GATE__H
+#define __ZUBROBOT_RISK_GATE__H
+
+
+#include "zubr-connector-ws/Request.hpp"
+
+#include "conf.hpp"
+#include "quotePolicy.hpp"
+
+
+namespace zubr {
+
+	/// @brief pre-trade checks of a single instrument, every check is a
+	/// comparison against counters maintained on order events
+	class riskGate {
+	protected:
+		confRisk m_conf;
+
+		/// @brief own rolling budget, independent of the quote policy one
+		messageBudget m_messageBudget;
+
+		int m_openOrders;
+		/// @brief open quantity by side, placements in flight included
+		int64_t m_openQuantity[2];
+
+	protected:
+		static size_t sideIndex( OrderDirection direction )
+		{
+			return ( OrderDirection::Buy == direction ? 0 : 1 );
+		}
+
+	public:
+		riskGate( const confRisk & conf );
+
+		/// @brief check placement
+		/// @param req
+		/// @param positionSize current position
+		/// @param referencePrice price band center, 0 - no band check
+		/// @param now
+		/// @param reason set if the order is rejected or clipped
+		/// @return quantity allowed, 0 - rejected
+		int Check( const PlaceOrderRequestWs & req,
+			int positionSize,
+			double referencePrice,
+			t_clock::time_point now,
+			const char *& reason ) const;
+
+		/// @brief check the position itself, a breach halts quoting
+		/// @param positionSize
+		/// @param referencePrice 0 - no notional check
+		/// @param reason set if breached
+		/// @return
+		bool IsBreached( int positionSize,
+			double referencePrice,
+			const char *& reason ) const;
+
+		/// @brief account placement sent
+		void OnPlace( OrderDirection direction,
+			int quantity,
+			t_clock::time_point now );
+
+		/// @brief account message not subject to the checks (cancel)
+		void OnMessage( t_clock::time_point now )
+		{
+			m_messageBudget.Consume( now, 1 );
+		}
+
+		/// @brief account (partial) fill of an open order
+		void OnFill( OrderDirection direction, int quantity )
+		{
+			m_openQuantity[sideIndex( direction )] -= quantity;
+		}
+
+		/// @brief account order no longer open (rejected, cancelled,
+		/// filled)
+		/// @param direction
+		/// @param quantityRemaining quantity released
+		void OnRemove( OrderDirection direction, int quantityRemaining )
+		{
+			--m_openOrders;
+			m_openQuantity[sideIndex( direction )] -= quantityRemaining;
+		}
+
+		/// @brief set counters recounted from the open orders
+		void Reset( int openOrders,
+			int64_t openBuyQuantity,
+			int64_t openSellQuantity );
+
+		int OpenOrders() const
+		{
+			return m_openOrders;
+		}
+	};
+
+} // namespace zubr
+
+
+#endif
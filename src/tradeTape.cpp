@@ -0,0 +1,135 @@
+/*
+MIT License
+
+Copyright (c) 2020 Denis Rozhkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// tradeTape.cpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#include <algorithm>
+#include <cmath>
+
+#include "tradeTape.hpp"
+
+
+using namespace zubr;
+
+
+tradeTape::tradeTape( const confTape & conf )
+	: m_conf( conf )
+	, m_trades( std::max( conf.Capacity(), 1 ) )
+	, m_head( 0 )
+	, m_size( 0 )
+	, m_lastPrice( 0 )
+	, m_sumPriceQuantity( 0 )
+	, m_sumQuantity( 0 )
+	, m_sumSignedQuantity( 0 )
+	, m_sumReturnSq( 0 )
+{
+}
+
+void tradeTape::OnTrade( t_clock::time_point at,
+	double price,
+	int quantity,
+	OrderDirection direction )
+{
+
+	if ( price <= 0 || quantity <= 0 ) {
+		return;
+	}
+
+	if ( m_trades.size() == m_size ) {
+		removeOldest();
+	}
+
+	tapeTrade trade;
+	trade.at = at;
+	trade.price = price;
+	trade.quantity = quantity;
+	trade.sign = ( OrderDirection::Buy == direction
+			? 1
+			: ( OrderDirection::Sell == direction ? -1 : 0 ) );
+
+	double r = ( m_lastPrice > 0 ? std::log( price / m_lastPrice ) : 0 );
+	trade.returnSq = r * r;
+
+	m_trades[( m_head + m_size ) % m_trades.size()] = trade;
+	++m_size;
+
+	m_lastPrice = price;
+
+	m_sumPriceQuantity += price * quantity;
+	m_sumQuantity += quantity;
+	m_sumSignedQuantity += trade.sign * quantity;
+	m_sumReturnSq += trade.returnSq;
+}
+
+void tradeTape::removeOldest()
+{
+	auto & trade = m_trades[m_head];
+
+	m_head = ( m_head + 1 ) % m_trades.size();
+	--m_size;
+
+	// an empty window starts the sums over, rounding errors of the
+	// subtractions do not accumulate
+	if ( 0 == m_size ) {
+		m_sumPriceQuantity = 0;
+		m_sumQuantity = 0;
+		m_sumSignedQuantity = 0;
+		m_sumReturnSq = 0;
+
+		return;
+	}
+
+	m_sumPriceQuantity -= trade.price * trade.quantity;
+	m_sumQuantity -= trade.quantity;
+	m_sumSignedQuantity -= trade.sign * trade.quantity;
+	m_sumReturnSq -= trade.returnSq;
+}
+
+void tradeTape::Expire( t_clock::time_point now )
+{
+	auto since = now - std::chrono::milliseconds( m_conf.WindowMs() );
+
+	while ( m_size > 0 && m_trades[m_head].at < since ) {
+		removeOldest();
+	}
+}
+
+void tradeTape::Clear()
+{
+	m_head = 0;
+	m_size = 0;
+	m_lastPrice = 0;
+	m_sumPriceQuantity = 0;
+	m_sumQuantity = 0;
+	m_sumSignedQuantity = 0;
+	m_sumReturnSq = 0;
+}
+
+double tradeTape::Volatility() const
+{
+	return std::sqrt( std::max( m_sumReturnSq, 0.0 ) );
+}
@@ -0,0 +1,141 @@
+/*
+MIT License
+
+Copyright (c) 2020 Denis Rozhkov
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/// tradeTape.hpp
+///
+/// 0.0 - created (Denis Rozhkov <denis@rozhkoff.com>)
+///
+
+#ifndef __ZUBROBOT_TRADE_TAPE__H
+#define __ZUBROBOT_TRADE_TAPE__H
+
+
+#include <vector>
+
+#include "zubr-core/Types.hpp"
+
+#include "conf.hpp"
+#include "quotePolicy.hpp"
+
+
+namespace zubr {
+
+	/// @brief public trade kept by the tape
+	struct tapeTrade {
+		t_clock::time_point at;
+		double price;
+		int quantity;
+		/// @brief +1 - buyer initiated, -1 - seller initiated, 0 - unknown
+		int sign;
+		/// @brief squared log return from the previous trade
+		double returnSq;
+	};
+
+	/// @brief ring of the latest public trades of an instrument; statistics
+	/// of the trades in the ring are running sums updated as trades enter
+	/// and leave, so a trade costs O(1) and nothing rescans the history
+	class tradeTape {
+	protected:
+		confTape m_conf;
+
+		std::vector<tapeTrade> m_trades;
+		/// @brief index of the oldest trade
+		size_t m_head;
+		size_t m_size;
+
+		/// @brief price of the latest trade, expired or not, 0 - none yet
+		double m_lastPrice;
+
+		double m_sumPriceQuantity;
+		double m_sumQuantity;
+		double m_sumSignedQuantity;
+		double m_sumReturnSq;
+
+	protected:
+		void removeOldest();
+
+	public:
+		tradeTape( const confTape & conf );
+
+		/// @brief append trade, the oldest leaves once the ring is full
+		/// @param at local time of the trade
+		/// @param price
+		/// @param quantity
+		/// @param direction aggressor side
+		void OnTrade( t_clock::time_point at,
+			double price,
+			int quantity,
+			OrderDirection direction );
+
+		/// @brief drop trades older than the window
+		/// @param now
+		void Expire( t_clock::time_point now );
+
+		void Clear();
+
+		size_t Size() const
+		{
+			return m_size;
+		}
+
+		/// @brief trade of the window
+		/// @param i 0 - the oldest
+		/// @return
+		const tapeTrade & At( size_t i ) const
+		{
+			return m_trades[( m_head + i ) % m_trades.size()];
+		}
+
+		/// @brief volume weighted average price, 0 - no trades
+		double Vwap() const
+		{
+			return ( m_sumQuantity > 0 ? m_sumPriceQuantity / m_sumQuantity
+									   : 0 );
+		}
+
+		/// @brief realized volatility, square root of the sum of squared
+		/// log returns of the window
+		double Volatility() const;
+
+		/// @brief buyer minus seller initiated volume over the volume,
+		/// -1 .. 1
+		double SignImbalance() const
+		{
+			return ( m_sumQuantity > 0 ? m_sumSignedQuantity / m_sumQuantity
+									   : 0 );
+		}
+
+		/// @brief trades per second over the window
+		double TradeRate() const
+		{
+			return ( m_conf.WindowMs() > 0
+						 ? m_size * 1000.0 / m_conf.WindowMs()
+						 : 0 );
+		}
+	};
+
+} // namespace zubr
+
+
+#endif